@@ -0,0 +1,129 @@
+/*
+ * adaptivePolicy.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include "compressedCache.h"
+
+#define PSEL_MAX 1023
+#define ADAPTIVE_MISS_COUNTERS 32   // policyCounters[32 + k]: misses of candidate k's leaders,
+                                    // the ones below are left to the candidates (CAMP's histogram)
+
+// Candidates keep no state of their own beyond the cache's CAMP weights
+static const ReplacementPolicy *const candidates[] = {&lruPolicy, &bestfitPolicy, &campPolicy};
+#define ADAPTIVE_CANDIDATES (sizeof(candidates) / sizeof(candidates[0]))
+
+typedef struct {
+    unsigned int period;            // Group k < ADAPTIVE_CANDIDATES of every period leads for candidate k
+    unsigned int winner;            // Candidate the follower sets use
+    unsigned int psel[ADAPTIVE_CANDIDATES]; // Saturating, grows while candidate k misses more than average
+    unsigned long epochsWon[ADAPTIVE_CANDIDATES];
+    unsigned long switches;
+} AdaptiveState;
+
+/* =====================================================================================
+ *
+ *                           Adaptive policy functions
+ *
+ * =====================================================================================
+ */
+
+static void *createAdaptiveState(const CacheGeometry *geometry) {
+    AdaptiveState *state = calloc(1, sizeof(AdaptiveState));
+    if (state == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    state->period = duelPeriod(geometry);
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        state->psel[k] = PSEL_MAX / 2;
+    }
+    return state;
+}
+
+// Leader group of set, ADAPTIVE_CANDIDATES for a follower
+static inline unsigned int leaderOf(const SimContext *ctx, const CacheSet *set) {
+    const AdaptiveState *state = ctx->cache->policyState;
+    unsigned int group = setIndex(ctx->cache, set) % state->period;
+    return group < ADAPTIVE_CANDIDATES ? group : ADAPTIVE_CANDIDATES;
+}
+
+static inline const ReplacementPolicy *policyOf(const SimContext *ctx, const CacheSet *set) {
+    const AdaptiveState *state = ctx->cache->policyState;
+    unsigned int leader = leaderOf(ctx, set);
+    return candidates[leader < ADAPTIVE_CANDIDATES ? leader : state->winner];
+}
+
+static bool adaptiveEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info) {
+    makeRoomInCacheSet(policyOf(ctx, set), ctx, set, line, info);
+    return true;
+}
+
+static void adaptiveInsert(SimContext *ctx, CacheSet *set, int slot) {
+    unsigned int leader = leaderOf(ctx, set);
+    if (leader < ADAPTIVE_CANDIDATES) {
+        ctx->policyCounters[ADAPTIVE_MISS_COUNTERS + leader]++;
+    }
+    const ReplacementPolicy *policy = policyOf(ctx, set);
+    if (policy->insert != NULL) {
+        policy->insert(ctx, set, slot);
+    }
+}
+
+static void adaptiveHit(SimContext *ctx, CacheSet *set, int slot) {
+    const ReplacementPolicy *policy = policyOf(ctx, set);
+    if (policy->hit != NULL) {
+        policy->hit(ctx, set, slot);
+    }
+}
+
+// Train the candidates, then move every PSEL by how far its leaders' misses were from
+// the average and hand the followers to the lowest one
+static void adaptiveTick(Cache *cache, const unsigned long *counters) {
+    AdaptiveState *state = cache->policyState;
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        if (candidates[k]->tick != NULL) {
+            candidates[k]->tick(cache, counters);
+        }
+    }
+
+    const unsigned long *misses = counters + ADAPTIVE_MISS_COUNTERS;
+    long total = 0;
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        total += misses[k];
+    }
+    unsigned int best = 0;
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        long psel = (long)state->psel[k] + (long)(ADAPTIVE_CANDIDATES * misses[k]) - total;
+        state->psel[k] = psel < 0 ? 0 : (psel > PSEL_MAX ? PSEL_MAX : psel);
+        if (state->psel[k] < state->psel[best]) {
+            best = k;
+        }
+    }
+
+    state->epochsWon[state->winner]++;
+    if (best != state->winner) {
+        state->switches++;
+        state->winner = best;
+    }
+}
+
+static void adaptiveReport(const Cache *cache) {
+    const AdaptiveState *state = cache->policyState;
+    unsigned long epochs = 0;
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        epochs += state->epochsWon[k];
+    }
+    printf("Follower policy:");
+    for (unsigned int k = 0; k < ADAPTIVE_CANDIDATES; k++) {
+        printf(" %s %.1f%%", candidates[k]->name, epochs == 0 ? 0.0 : 100.0 * state->epochsWon[k] / epochs);
+    }
+    printf(" of %lu epochs, %lu switches\n", epochs, state->switches);
+}
+
+const ReplacementPolicy adaptivePolicy = {
+    .name = "adaptive", .evict = adaptiveEvict, .insert = adaptiveInsert, .hit = adaptiveHit,
+    .createState = createAdaptiveState, .tick = adaptiveTick, .report = adaptiveReport
+};
@@ -2,12 +2,17 @@
  * Original Code: https://github.com/CMU-SAFARI/BDICompression.git
  * 
  * Modified by Penggao Li
- * Last modified: 04/27/2024
+ * Last modified: 10/17/2026
  */
 
-#include "bdi.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
-EndianType type = BIG;
+#include "bdi.h"
 
 unsigned long long my_llabs(long long x)
 {
@@ -307,161 +312,484 @@ CompressionResult setCompResult(unsigned isZero, unsigned isSame, unsigned compS
     result.compSize = compSize;
     result.K = K;
     result.BaseNum = baseNum;
+    result.algorithm = 0;
+    result.stored = 0;
     return result;
 }
 
-CompressionResult BDICompress(unsigned char *buffer, unsigned _blockSize)
+#define BDI_CHUNK 64 // Bytes of a line held on the stack at a time
+
+// Limits of the 1, 2 and 4-byte deltas
+static const unsigned long long deltaLimits[] = {0xFF, 0xFFFF, 0xFFFFFFFF};
+
+// Base + delta encoding of one value width with one delta width. Same sizes as
+// multBaseCompression with two bases: the implicit zero base and the first value that is
+// not within limit of zero
+typedef struct
+{
+    unsigned long long base;
+    unsigned baseCount;
+    unsigned nearZero; // Values within limit of the zero base, the others are near base
+    int fits;          // Every value was within limit of a base
+} DeltaState;
+
+// Every value of one width: sameness and a DeltaState per delta width
+typedef struct
 {
-    long long unsigned *values = NULL;
-    unsigned bestCSize = 0;
-    unsigned currCSize = 0;
+    unsigned bsize;
+    unsigned shift;      // log2(bsize), value counts are shifts rather than divisions
+    unsigned count;
+    unsigned long long first;
+    int same;
+    unsigned deltaCount;
+    DeltaState delta[3]; // 1, 2 and 4-byte deltas, the first deltaCount of them
+} WidthState;
 
-    CompressionResult result = {0, 0, _blockSize, 0, 0};
-    CurrCompResult currResult = {0, _blockSize};
+// my_llabs((long long)(base - value)) <= limit without the branches
+static inline int withinLimit(unsigned long long value, unsigned long long base, unsigned long long limit)
+{
+    return base - value + limit <= 2 * limit;
+}
 
-    values = convertBuffer2Array(buffer, _blockSize, 8, type);
-    // printValuesArr(values, _blockSize, 8);
-    bestCSize = _blockSize;
-    currCSize = _blockSize;
-    if (isZeroPackable(values, _blockSize / 8))
+static CurrCompResult deltaCompResult(const WidthState *width, unsigned k)
+{
+    const DeltaState *delta = &(width->delta[k]);
+    CurrCompResult result = {delta->baseCount, width->count * width->bsize};
+    if (delta->fits)
     {
-        // bestCSize = 1;
-        result = setCompResult(1, 1, 1, 8, 1);
-        free(values);
-        return result;
+        unsigned nearBase = width->count - delta->nearZero;
+        result.compSize = delta->baseCount * width->bsize + delta->nearZero + nearBase * 2;
     }
-    if (isSameValuePackable(values, _blockSize / 8))
+    return result;
+}
+
+static inline int swapBytes(EndianType endianType)
+{
+    return endianType == (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ ? BIG : LITTLE);
+}
+
+// readBytesAsInteger for the 8, 4 and 2-byte widths in one load
+static inline __attribute__((always_inline)) unsigned long long loadValue(const unsigned char *bytes, unsigned bsize, int swap)
+{
+    if (bsize == 8)
     {
-        currCSize = 8;
-        bestCSize = bestCSize > currCSize ? currCSize : bestCSize;
-        result = setCompResult(0, 1, 8, 8, 1);
+        uint64_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return swap ? __builtin_bswap64(value) : value;
     }
-    else
+    if (bsize == 4)
     {
-        currResult = multBaseCompression(values, _blockSize / 8, 1, 8, 2);
-        currCSize = currResult.compSize;
-        if (currCSize < bestCSize)
-        {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 8, currResult.baseCount);
-        }
-        currResult = multBaseCompression(values, _blockSize / 8, 2, 8, 2);
-        currCSize = currResult.compSize;
-        if (currCSize < bestCSize)
+        uint32_t value;
+        memcpy(&value, bytes, sizeof(value));
+        return swap ? __builtin_bswap32(value) : value;
+    }
+    uint16_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return swap ? __builtin_bswap16(value) : value;
+}
+
+// Every whole bsize-byte value of size bytes, trailing bytes are ignored
+static inline __attribute__((always_inline)) unsigned loadValues(const unsigned char *bytes, unsigned size, unsigned bsize, int swap, unsigned long long *values)
+{
+    unsigned count = size >> __builtin_ctz(bsize);
+    for (unsigned i = 0; i < count; i++)
+    {
+        values[i] = loadValue(bytes + i * bsize, bsize, swap);
+    }
+    return count;
+}
+
+static inline __attribute__((always_inline)) void storeWidthState(WidthState *width, unsigned blockSize, unsigned bsize, unsigned long long first, int same,
+                                                                    unsigned deltaCount, const unsigned long long *base, const unsigned *baseCount,
+                                                                    const unsigned *nearZero, const int *fits)
+{
+    width->bsize = bsize;
+    width->shift = __builtin_ctz(bsize);
+    width->count = blockSize >> width->shift;
+    width->first = first;
+    width->same = same;
+    width->deltaCount = deltaCount;
+    for (unsigned k = 0; k < deltaCount; k++)
+    {
+        DeltaState delta = {base[k], baseCount[k], nearZero[k], fits[k]};
+        width->delta[k] = delta;
+    }
+}
+
+// One pass over the block at bsize bytes per value, checking every delta width at once
+// with BDI_CHUNK bytes of values on the stack at a time. bsize and deltaCount are
+// constants at every call, so the loops unroll and the state stays in registers
+static inline __attribute__((always_inline)) void evaluateWidth(WidthState *width, const unsigned char *buffer, unsigned blockSize,
+                                                                  EndianType endianType, unsigned bsize, unsigned deltaCount)
+{
+    int swap = swapBytes(endianType);
+    unsigned long long values[BDI_CHUNK / 2];
+    unsigned long long first = 0;
+    unsigned long long base[3] = {0, 0, 0};
+    unsigned baseCount[3] = {1, 1, 1};
+    unsigned nearZero[3] = {0, 0, 0};
+    int fits[3] = {1, 1, 1};
+    int same = 1;
+    int anyFits = 1;
+
+    for (unsigned offset = 0; offset < blockSize && anyFits; offset += BDI_CHUNK)
+    {
+        unsigned size = blockSize - offset < BDI_CHUNK ? blockSize - offset : BDI_CHUNK;
+        unsigned count = loadValues(buffer + offset, size, bsize, swap, values);
+        if (offset == 0 && count > 0)
         {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 8, currResult.baseCount);
+            first = values[0];
         }
-        currResult = multBaseCompression(values, _blockSize / 8, 4, 8, 2);
-        currCSize = currResult.compSize;
-        if (currCSize < bestCSize)
+        for (unsigned i = 0; i < count; i++)
         {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 8, currResult.baseCount);
+            unsigned long long value = values[i];
+            same &= value == first;
+            anyFits = 0;
+#pragma GCC unroll 3
+            for (unsigned k = 0; k < deltaCount; k++)
+            {
+                // Branch free: the first value that is not near zero becomes the second
+                // base, and is then trivially near it
+                int zero = withinLimit(value, 0, deltaLimits[k]);
+                int newBase = !zero & (baseCount[k] == 1);
+                base[k] = newBase ? value : base[k];
+                baseCount[k] += newBase;
+                nearZero[k] += zero;
+                fits[k] &= zero | withinLimit(value, base[k], deltaLimits[k]);
+                anyFits |= fits[k];
+            }
+            // Values that fit no encoding cannot be all the same either
+            if (!anyFits)
+            {
+                same = 0;
+                break;
+            }
         }
     }
-    free(values);
 
-    //===================================================================
-    values = convertBuffer2Array(buffer, _blockSize, 4, type);
-    // printValuesArr(values, _blockSize, 4);
-    if (isSameValuePackable(values, _blockSize / 4))
+    storeWidthState(width, blockSize, bsize, first, same, deltaCount, base, baseCount, nearZero, fits);
+}
+
+static void evaluateWidthScalar(WidthState *width, const unsigned char *buffer, unsigned blockSize, EndianType endianType, unsigned w)
+{
+    if (w == 0)
+    {
+        evaluateWidth(width, buffer, blockSize, endianType, 8, 3);
+    }
+    else if (w == 1)
     {
-        currCSize = 4;
-        bestCSize = bestCSize > currCSize ? currCSize : bestCSize;
-        result = setCompResult(0, 1, 4, 4, 1);
+        evaluateWidth(width, buffer, blockSize, endianType, 4, 2);
     }
     else
     {
-        currResult = multBaseCompression(values, _blockSize / 4, 1, 4, 2);
-        currCSize = currResult.compSize;
-        // printf("\n%d", currCSize);
-        if (currCSize < bestCSize)
-        {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 4, currResult.baseCount);
-        }
-        currResult = multBaseCompression(values, _blockSize / 4, 2, 4, 2);
-        currCSize = currResult.compSize;
-        // printf("\n%d\n", currCSize);
-        if (currCSize < bestCSize)
+        evaluateWidth(width, buffer, blockSize, endianType, 2, 1);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/* =====================================================================================
+ *
+ *   AVX2 kernel: a 64-byte chunk is two vectors of 4, 8 or 16 values, and every test is
+ *   a compare over all of them at once, giving one mask bit per value
+ *
+ * =====================================================================================
+ */
+
+#define AVX2 __attribute__((target("avx2"), always_inline)) static inline
+
+// One mask bit per value of the two vectors, from lanes that are all ones or all zeros
+AVX2 uint32_t laneMask(__m256i low, __m256i high, unsigned bsize)
+{
+    if (bsize == 8)
+    {
+        return _mm256_movemask_pd(_mm256_castsi256_pd(low)) | _mm256_movemask_pd(_mm256_castsi256_pd(high)) << 4;
+    }
+    if (bsize == 4)
+    {
+        return _mm256_movemask_ps(_mm256_castsi256_ps(low)) | _mm256_movemask_ps(_mm256_castsi256_ps(high)) << 8;
+    }
+    // Packing interleaves the 128-bit halves, the permute puts the bytes back in order
+    __m256i packed = _mm256_packs_epi16(low, high);
+    return _mm256_movemask_epi8(_mm256_permute4x64_epi64(packed, 0xD8));
+}
+
+AVX2 __m256i equalLanes(__m256i values, __m256i key, unsigned bsize)
+{
+    return bsize == 8 ? _mm256_cmpeq_epi64(values, key) : bsize == 4 ? _mm256_cmpeq_epi32(values, key) : _mm256_cmpeq_epi16(values, key);
+}
+
+AVX2 __m256i broadcast(unsigned long long value, unsigned bsize)
+{
+    return bsize == 8 ? _mm256_set1_epi64x(value) : bsize == 4 ? _mm256_set1_epi32(value) : _mm256_set1_epi16(value);
+}
+
+// withinLimit on every lane. 8-byte values use the same wrapping range test with the
+// sign flipped for the signed compare; narrower values are zero extended in the scalar
+// path, so there the distance is max - min, which cannot wrap
+AVX2 __m256i nearLanes(__m256i values, unsigned long long base, unsigned long long limit, unsigned bsize)
+{
+    if (bsize == 8)
+    {
+        __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+        __m256i shifted = _mm256_sub_epi64(_mm256_set1_epi64x(base + limit), values);
+        __m256i far = _mm256_cmpgt_epi64(_mm256_xor_si256(shifted, sign), _mm256_set1_epi64x((2 * limit) ^ INT64_MIN));
+        return _mm256_xor_si256(far, _mm256_set1_epi64x(-1));
+    }
+    __m256i key = broadcast(base, bsize);
+    __m256i bound = broadcast(limit, bsize);
+    if (bsize == 4)
+    {
+        __m256i distance = _mm256_sub_epi32(_mm256_max_epu32(values, key), _mm256_min_epu32(values, key));
+        return _mm256_cmpeq_epi32(_mm256_min_epu32(distance, bound), distance);
+    }
+    __m256i distance = _mm256_sub_epi16(_mm256_max_epu16(values, key), _mm256_min_epu16(values, key));
+    return _mm256_cmpeq_epi16(_mm256_min_epu16(distance, bound), distance);
+}
+
+// The values of a chunk in byte order, zero padded past size
+AVX2 void loadChunk(const unsigned char *bytes, unsigned size, unsigned bsize, int swap, __m256i chunk[2])
+{
+    if (size == BDI_CHUNK)
+    {
+        chunk[0] = _mm256_loadu_si256((const __m256i *)bytes);
+        chunk[1] = _mm256_loadu_si256((const __m256i *)(bytes + 32));
+    }
+    else
+    {
+        unsigned char padded[BDI_CHUNK] = {0};
+        memcpy(padded, bytes, size);
+        chunk[0] = _mm256_loadu_si256((const __m256i *)padded);
+        chunk[1] = _mm256_loadu_si256((const __m256i *)(padded + 32));
+    }
+    if (swap)
+    {
+        __m256i reverse = bsize == 8 ? _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,
+                                                       8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7)
+                          : bsize == 4 ? _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                                         12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)
+                                       : _mm256_set_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                                                         14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1);
+        chunk[0] = _mm256_shuffle_epi8(chunk[0], reverse);
+        chunk[1] = _mm256_shuffle_epi8(chunk[1], reverse);
+    }
+}
+
+// evaluateWidth with the per-value loop replaced by masks: the second base is the first
+// value outside the zero mask, and a delta width fits when every value is in either mask
+AVX2 void evaluateWidthVector(WidthState *width, const unsigned char *buffer, unsigned blockSize,
+                              EndianType endianType, unsigned bsize, unsigned deltaCount)
+{
+    int swap = swapBytes(endianType);
+    unsigned long long first = blockSize >= bsize ? loadValue(buffer, bsize, swap) : 0;
+    __m256i firstLanes = broadcast(first, bsize);
+    unsigned long long base[3] = {0, 0, 0};
+    unsigned baseCount[3] = {1, 1, 1};
+    unsigned nearZero[3] = {0, 0, 0};
+    int fits[3] = {1, 1, 1};
+    int same = 1;
+    int anyFits = 1;
+
+    for (unsigned offset = 0; offset < blockSize && anyFits; offset += BDI_CHUNK)
+    {
+        unsigned size = blockSize - offset < BDI_CHUNK ? blockSize - offset : BDI_CHUNK;
+        unsigned count = size >> __builtin_ctz(bsize);
+        uint32_t valid = count == 32 ? UINT32_MAX : (1u << count) - 1;
+        __m256i chunk[2];
+        loadChunk(buffer + offset, size, bsize, swap, chunk);
+
+        uint32_t equal = laneMask(equalLanes(chunk[0], firstLanes, bsize), equalLanes(chunk[1], firstLanes, bsize), bsize);
+        same &= (equal & valid) == valid;
+        anyFits = 0;
+#pragma GCC unroll 3
+        for (unsigned k = 0; k < deltaCount; k++)
         {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 4, currResult.baseCount);
+            if (!fits[k])
+            {
+                continue;
+            }
+            uint32_t zero = laneMask(nearLanes(chunk[0], 0, deltaLimits[k], bsize), nearLanes(chunk[1], 0, deltaLimits[k], bsize), bsize) & valid;
+            nearZero[k] += __builtin_popcount(zero);
+            if (zero == valid)
+            {
+                anyFits = 1;
+                continue;
+            }
+            if (baseCount[k] == 1)
+            {
+                base[k] = loadValue(buffer + offset + __builtin_ctz(~zero & valid) * bsize, bsize, swap);
+                baseCount[k] = 2;
+            }
+            uint32_t near = laneMask(nearLanes(chunk[0], base[k], deltaLimits[k], bsize), nearLanes(chunk[1], base[k], deltaLimits[k], bsize), bsize);
+            fits[k] = ((zero | near) & valid) == valid;
+            anyFits |= fits[k];
         }
     }
-    free(values);
+    // Values that fit no encoding cannot be all the same either
+    same &= anyFits;
 
-    //===================================================================
-    values = convertBuffer2Array(buffer, _blockSize, 2, type);
-    // printValuesArr(values, _blockSize, 2);
-    if (isSameValuePackable(values, _blockSize / 2))
+    storeWidthState(width, blockSize, bsize, first, same, deltaCount, base, baseCount, nearZero, fits);
+}
+
+__attribute__((target("avx2"))) static void evaluateWidthAVX2(WidthState *width, const unsigned char *buffer, unsigned blockSize, EndianType endianType, unsigned w)
+{
+    if (w == 0)
     {
-        result = setCompResult(0, 1, 2, 2, 1);
-        free(values);
-        return result;
+        evaluateWidthVector(width, buffer, blockSize, endianType, 8, 3);
+    }
+    else if (w == 1)
+    {
+        evaluateWidthVector(width, buffer, blockSize, endianType, 4, 2);
     }
     else
     {
-        currResult = multBaseCompression(values, _blockSize / 2, 1, 2, 2);
-        currCSize = currResult.compSize;
-        if (currCSize < bestCSize)
+        evaluateWidthVector(width, buffer, blockSize, endianType, 2, 1);
+    }
+}
+
+#endif
+
+typedef void (*WidthKernel)(WidthState *width, const unsigned char *buffer, unsigned blockSize, EndianType endianType, unsigned w);
+
+static WidthKernel widthKernel = evaluateWidthScalar;
+static const char *widthKernelName = "scalar";
+
+void selectBDIKernel(int forceScalar)
+{
+    widthKernel = evaluateWidthScalar;
+    widthKernelName = "scalar";
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (!forceScalar && __builtin_cpu_supports("avx2"))
+    {
+        widthKernel = evaluateWidthAVX2;
+        widthKernelName = "avx2";
+    }
+#endif
+}
+
+const char *BDIKernelName(void)
+{
+    return widthKernelName;
+}
+
+// Picked once from CPUID before main runs
+__attribute__((constructor)) static void initializeBDIKernel(void)
+{
+    selectBDIKernel(0);
+}
+
+// All the whole bsize-byte values of the block are equal, whatever their byte order
+static int sameValues(const unsigned char *buffer, unsigned blockSize, unsigned bsize)
+{
+    unsigned count = blockSize >> __builtin_ctz(bsize);
+    return count <= 1 || memcmp(buffer, buffer + bsize, (count - 1) * bsize) == 0;
+}
+
+///
+/// Every width's values are loaded once into stack storage and checked against all of
+/// their base/delta encodings in the same pass, so nothing is allocated. Returns what
+/// the convertBuffer2Array + multBaseCompression passes of every width would have
+///
+CompressionResult BDICompress(unsigned char *buffer, unsigned _blockSize, EndianType endianType)
+{
+    static const unsigned bsizes[] = {8, 4, 2};
+    WidthState widths[3];
+
+    // Same order and tie breaking as the per-width passes: a narrower width only wins
+    // when strictly smaller, except that a same-value line always takes it
+    CompressionResult result = {0, 0, _blockSize, 0, 0, 0, 1};
+    unsigned bestCSize = _blockSize;
+    for (unsigned w = 0; w < 3; w++)
+    {
+        WidthState *width = &widths[w];
+        // Values that are all the same are all the same at twice the width too, and no
+        // encoding is smaller than one base plus a byte per value or than no encoding
+        unsigned count = _blockSize / bsizes[w];
+        unsigned smallest = bsizes[w] + count < count * bsizes[w] ? bsizes[w] + count : count * bsizes[w];
+        if (w > 0 && smallest >= bestCSize)
         {
-            bestCSize = currCSize;
-            result = setCompResult(0, 0, bestCSize, 2, currResult.baseCount);
+            // Only a same-value line can still win at this width
+            width->bsize = bsizes[w];
+            width->same = widths[w - 1].same && sameValues(buffer, _blockSize, bsizes[w]);
+            width->deltaCount = 0;
+        }
+        else
+        {
+            widthKernel(width, buffer, _blockSize, endianType, w);
         }
-    }
-    free(values);
 
-    // delete [] buffer;
-    buffer = NULL;
-    values = NULL;
-    // printf("\ncompSize: %d\n", result.compSize);
+        if (w == 0 && width->same && width->first == 0)
+        {
+            return setCompResult(1, 1, 1, 8, 1);
+        }
+        if (width->same)
+        {
+            bestCSize = bestCSize > width->bsize ? width->bsize : bestCSize;
+            result = setCompResult(0, 1, width->bsize, width->bsize, 1);
+            if (width->bsize == 2)
+            {
+                return result;
+            }
+            continue;
+        }
+        for (unsigned k = 0; k < width->deltaCount; k++)
+        {
+            CurrCompResult currResult = deltaCompResult(width, k);
+            if (currResult.compSize < bestCSize)
+            {
+                bestCSize = currResult.compSize;
+                result = setCompResult(0, 0, bestCSize, width->bsize, currResult.baseCount);
+            }
+        }
+    }
     return result;
 }
 
-unsigned FPCCompress(unsigned char *buffer, unsigned size)
+unsigned FPCCompress(unsigned char *buffer, unsigned size, EndianType endianType)
 {
-    long long unsigned *values = convertBuffer2Array(buffer, size * 4, 4, type);
+    // Words are read in place, one load each, rather than copied to a heap array
+    int swap = swapBytes(endianType);
     unsigned compressable = 0;
     unsigned int i;
     for (i = 0; i < size; i++)
     {
+        unsigned long long value = loadValue(buffer + 4 * i, 4, swap);
         //  000
-        if (values[i] == 0)
+        if (value == 0)
         {
             compressable += 1;
             continue;
         }
         // 001 010
-        if (my_abs((int)(values[i])) <= 0xFF)
+        if (my_abs((int)(value)) <= 0xFF)
         {
             compressable += 1;
             continue;
         }
         // 011
-        if (my_abs((int)(values[i])) <= 0xFFFF)
+        if (my_abs((int)(value)) <= 0xFFFF)
         {
             compressable += 2;
             continue;
         }
         // 100
-        if (((values[i]) & 0xFFFF) == 0)
+        if (((value) & 0xFFFF) == 0)
         {
             compressable += 2;
             continue;
         }
         // 101
-        if (my_abs((int)((values[i]) & 0xFFFF)) <= 0xFF && my_abs((int)((values[i] >> 16) & 0xFFFF)) <= 0xFF)
+        if (my_abs((int)((value) & 0xFFFF)) <= 0xFF && my_abs((int)((value >> 16) & 0xFFFF)) <= 0xFF)
         {
             compressable += 2;
             continue;
         }
         // 110
-        unsigned byte0 = (values[i]) & 0xFF;
-        unsigned byte1 = (values[i] >> 8) & 0xFF;
-        unsigned byte2 = (values[i] >> 16) & 0xFF;
-        unsigned byte3 = (values[i] >> 24) & 0xFF;
+        unsigned byte0 = (value) & 0xFF;
+        unsigned byte1 = (value >> 8) & 0xFF;
+        unsigned byte2 = (value >> 16) & 0xFF;
+        unsigned byte3 = (value >> 24) & 0xFF;
         if (byte0 == byte1 && byte0 == byte2 && byte0 == byte3)
         {
             compressable += 1;
@@ -470,7 +798,6 @@ unsigned FPCCompress(unsigned char *buffer, unsigned size)
         // 111
         compressable += 4;
     }
-    free(values);
     // 6 bytes for 3 bit per every 4-byte word in a 64 byte cache line
     unsigned compSize = compressable + size * 3 / 8;
     if (compSize < size * 4)
@@ -479,39 +806,358 @@ unsigned FPCCompress(unsigned char *buffer, unsigned size)
         return size * 4;
 }
 
-// unsigned GeneralCompress(char *buffer, unsigned _blockSize, unsigned compress)
-// { // compress is the actual compression algorithm
-//     switch (compress)
-//     {
-//     case 0:
-//         return _blockSize;
-//         break;
-//     case 1:
-//         return BDICompress(buffer, _blockSize);
-//         break;
-//     case 2:
-//         return FPCCompress(buffer, _blockSize / 4);
-//         break;
-//     case 3:
-//     {
-//         unsigned BDISize = BDICompress(buffer, _blockSize);
-//         unsigned FPCSize = FPCCompress(buffer, _blockSize / 4);
-//         if (BDISize <= FPCSize)
-//         {
-//             printf("Use BDI: %d (FPC: %d)\n", BDISize, FPCSize);
-//             return BDISize;
-//         }
-//         else
-//         {
-//             printf("Use FPC: %d (BDI: %d)\n", FPCSize, BDISize);
-//             return FPCSize;
-//         }
-//         break;
-//     }
-//     default:
-//         exit(1);
-//     }
-// }
+/* =====================================================================================
+ *
+ *   Encoder and decoder: an encoding id byte (the tag-store metadata in hardware)
+ *   followed by the payload. Base + delta payloads are the explicit base, one bit per
+ *   value selecting it over the implicit zero base, then one signed delta per value
+ *
+ * =====================================================================================
+ */
+
+static const struct
+{
+    const char *name;
+    unsigned bsize; // 0: not a base + delta encoding
+    unsigned dsize;
+} bdiEncodings[BDI_ENCODINGS] = {
+    [BDI_ZEROS] = {"zeros", 0, 0},
+    [BDI_REPEATED] = {"repeated", 0, 0},
+    [BDI_BASE8_DELTA1] = {"base8-delta1", 8, 1},
+    [BDI_BASE8_DELTA2] = {"base8-delta2", 8, 2},
+    [BDI_BASE8_DELTA4] = {"base8-delta4", 8, 4},
+    [BDI_BASE4_DELTA1] = {"base4-delta1", 4, 1},
+    [BDI_BASE4_DELTA2] = {"base4-delta2", 4, 2},
+    [BDI_BASE2_DELTA1] = {"base2-delta1", 2, 1},
+    [BDI_UNCOMPRESSED] = {"uncompressed", 0, 0},
+};
+
+const char *BDIEncodingName(BDIEncoding encoding)
+{
+    return encoding < BDI_ENCODINGS ? bdiEncodings[encoding].name : "invalid";
+}
+
+static inline void storeValue(unsigned char *bytes, unsigned bsize, int swap, unsigned long long value)
+{
+    if (bsize == 8)
+    {
+        uint64_t word = swap ? __builtin_bswap64(value) : value;
+        memcpy(bytes, &word, sizeof(word));
+    }
+    else if (bsize == 4)
+    {
+        uint32_t word = swap ? __builtin_bswap32(value) : value;
+        memcpy(bytes, &word, sizeof(word));
+    }
+    else if (bsize == 2)
+    {
+        uint16_t word = swap ? __builtin_bswap16(value) : value;
+        memcpy(bytes, &word, sizeof(word));
+    }
+    else
+    {
+        bytes[0] = value;
+    }
+}
+
+// value sign extended from its low bytes bytes
+static inline long long signExtend(unsigned long long value, unsigned bytes)
+{
+    unsigned shift = 64 - 8 * bytes;
+    return (long long)(value << shift) >> shift;
+}
+
+// Payload bytes of an encoding, 0 when it does not apply to lines of lineSize bytes
+unsigned BDIPayloadSize(BDIEncoding encoding, unsigned lineSize)
+{
+    unsigned bsize = bdiEncodings[encoding].bsize;
+    switch (encoding)
+    {
+    case BDI_ZEROS:
+        return 1;
+    case BDI_REPEATED:
+        return lineSize % 8 == 0 ? 8 : 0;
+    case BDI_UNCOMPRESSED:
+        return lineSize;
+    default:
+        if (lineSize % bsize != 0)
+        {
+            return 0;
+        }
+        unsigned count = lineSize / bsize;
+        return bsize + (count + 7) / 8 + count * bdiEncodings[encoding].dsize;
+    }
+}
+
+// The payload of a base + delta encoding, or 0 when some value is more than a delta
+// away from both bases
+static unsigned encodeBaseDelta(const unsigned char *line, unsigned lineSize, int swap, BDIEncoding encoding, unsigned char *payload)
+{
+    unsigned bsize = bdiEncodings[encoding].bsize;
+    unsigned dsize = bdiEncodings[encoding].dsize;
+    unsigned count = lineSize / bsize;
+    unsigned char *mask = payload + bsize;
+    unsigned char *deltas = mask + (count + 7) / 8;
+    int haveBase = 0;
+    unsigned long long base = 0;
+    memset(mask, 0, (count + 7) / 8);
+    for (unsigned i = 0; i < count; i++)
+    {
+        unsigned long long value = loadValue(line + i * bsize, bsize, swap);
+        long long delta = signExtend(value, bsize);
+        if (signExtend(delta, dsize) != delta)
+        {
+            if (!haveBase)
+            {
+                base = value;
+                haveBase = 1;
+            }
+            delta = signExtend(value - base, bsize);
+            if (signExtend(delta, dsize) != delta)
+            {
+                return 0;
+            }
+            mask[i / 8] |= 1 << (i % 8);
+        }
+        storeValue(deltas + i * dsize, dsize, swap, delta);
+    }
+    storeValue(payload, bsize, swap, base);
+    return BDIPayloadSize(encoding, lineSize);
+}
+
+static int isRepeated(const unsigned char *line, unsigned lineSize)
+{
+    return lineSize % 8 == 0 && sameValues(line, lineSize, 8);
+}
+
+static int isZeros(const unsigned char *line, unsigned lineSize)
+{
+    return lineSize == 0 || (line[0] == 0 && memcmp(line, line + 1, lineSize - 1) == 0);
+}
+
+unsigned BDIEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out)
+{
+    int swap = swapBytes(endianType);
+    // Smallest payload first, ties in enum order
+    BDIEncoding order[BDI_ENCODINGS];
+    unsigned count = 0;
+    for (unsigned e = 0; e < BDI_ENCODINGS; e++)
+    {
+        unsigned size = BDIPayloadSize(e, lineSize);
+        if (size == 0)
+        {
+            continue;
+        }
+        unsigned i = count++;
+        for (; i > 0 && BDIPayloadSize(order[i - 1], lineSize) > size; i--)
+        {
+            order[i] = order[i - 1];
+        }
+        order[i] = e;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        BDIEncoding encoding = order[i];
+        unsigned size = 0;
+        switch (encoding)
+        {
+        case BDI_ZEROS:
+            size = isZeros(line, lineSize) ? 1 : 0;
+            out[1] = 0;
+            break;
+        case BDI_REPEATED:
+            size = isRepeated(line, lineSize) ? 8 : 0;
+            memcpy(out + 1, line, size);
+            break;
+        case BDI_UNCOMPRESSED:
+            size = lineSize;
+            memcpy(out + 1, line, size);
+            break;
+        default:
+            size = encodeBaseDelta(line, lineSize, swap, encoding, out + 1);
+        }
+        if (size != 0)
+        {
+            out[0] = encoding;
+            return 1 + size;
+        }
+    }
+    return 0; // Not reached, uncompressed always applies
+}
+
+unsigned BDIDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line)
+{
+    int swap = swapBytes(endianType);
+    BDIEncoding encoding = encoded[0];
+    if (encoding >= BDI_ENCODINGS || BDIPayloadSize(encoding, lineSize) == 0)
+    {
+        return 0;
+    }
+    const unsigned char *payload = encoded + 1;
+    switch (encoding)
+    {
+    case BDI_ZEROS:
+        memset(line, 0, lineSize);
+        break;
+    case BDI_REPEATED:
+        for (unsigned i = 0; i < lineSize; i += 8)
+        {
+            memcpy(line + i, payload, 8);
+        }
+        break;
+    case BDI_UNCOMPRESSED:
+        memcpy(line, payload, lineSize);
+        break;
+    default:
+    {
+        unsigned bsize = bdiEncodings[encoding].bsize;
+        unsigned dsize = bdiEncodings[encoding].dsize;
+        unsigned count = lineSize / bsize;
+        unsigned long long base = loadValue(payload, bsize, swap);
+        const unsigned char *mask = payload + bsize;
+        const unsigned char *deltas = mask + (count + 7) / 8;
+        for (unsigned i = 0; i < count; i++)
+        {
+            unsigned long long delta = dsize == 1 ? deltas[i] : loadValue(deltas + i * dsize, dsize, swap);
+            unsigned long long value = signExtend(delta, dsize);
+            if ((mask[i / 8] >> (i % 8)) & 1)
+            {
+                value += base;
+            }
+            storeValue(line + i * bsize, bsize, swap, value);
+        }
+    }
+    }
+    return 1 + BDIPayloadSize(encoding, lineSize);
+}
+
+CompressionResult BDIEncodedResult(const unsigned char *line, unsigned lineSize, EndianType endianType)
+{
+    unsigned char chunk[BDI_CHUNK + 1];
+    unsigned char *encoded = lineSize <= BDI_CHUNK ? chunk : (unsigned char *)malloc(lineSize + 1);
+    if (encoded == NULL)
+    {
+        perror("Failed to allocate the encoded line");
+        exit(EXIT_FAILURE);
+    }
+    BDIEncode(line, lineSize, endianType, encoded);
+    BDIEncoding encoding = encoded[0];
+    if (encoded != chunk)
+    {
+        free(encoded);
+    }
+
+    unsigned compSize = BDIPayloadSize(encoding, lineSize);
+    CompressionResult result;
+    switch (encoding)
+    {
+    case BDI_ZEROS:
+        return setCompResult(1, 1, compSize, 8, 1);
+    case BDI_REPEATED:
+        return setCompResult(0, 1, compSize, 8, 1);
+    case BDI_UNCOMPRESSED:
+        result = setCompResult(0, 0, compSize, 0, 0);
+        result.stored = 1;
+        return result;
+    default:
+        return setCompResult(0, 0, compSize, bdiEncodings[encoding].bsize, 2);
+    }
+}
+
+/* =====================================================================================
+ *
+ *   Batches: many lines per call, split into contiguous ranges across threads
+ *
+ * =====================================================================================
+ */
+
+#define BATCH_BYTES_PER_THREAD (1 << 20) // Smaller batches are not worth a thread
+
+typedef struct
+{
+    const unsigned char *lines;
+    size_t begin;
+    size_t end;
+    unsigned lineSize;
+    EndianType endianType;
+    CompressionResult *results; // BDI batches
+    unsigned *sizes;            // FPC batches
+} BatchRange;
+
+static void *compressBatchRange(void *arg)
+{
+    const BatchRange *range = arg;
+    unsigned char *line = (unsigned char *)range->lines + range->begin * range->lineSize;
+    if (range->results != NULL)
+    {
+        for (size_t i = range->begin; i < range->end; i++, line += range->lineSize)
+        {
+            range->results[i] = BDICompress(line, range->lineSize, range->endianType);
+        }
+    }
+    else
+    {
+        for (size_t i = range->begin; i < range->end; i++, line += range->lineSize)
+        {
+            range->sizes[i] = FPCCompress(line, range->lineSize / 4, range->endianType);
+        }
+    }
+    return NULL;
+}
+
+// Lines are independent, so every thread takes a contiguous range and the calling
+// thread takes the first one
+static void compressBatch(BatchRange whole, size_t count, unsigned threads)
+{
+    size_t useful = (size_t)count * whole.lineSize / BATCH_BYTES_PER_THREAD;
+    if (threads > useful)
+    {
+        threads = useful;
+    }
+    if (threads == 0)
+    {
+        threads = 1;
+    }
+    BatchRange ranges[threads];
+    pthread_t workers[threads];
+    unsigned started = 0;
+    for (unsigned t = 0; t < threads; t++)
+    {
+        ranges[t] = whole;
+        ranges[t].begin = count * t / threads;
+        ranges[t].end = count * (t + 1) / threads;
+    }
+    for (unsigned t = 1; t < threads; t++)
+    {
+        if (pthread_create(&workers[t], NULL, compressBatchRange, &ranges[t]) != 0)
+        {
+            break; // The remaining ranges are compressed on this thread
+        }
+        started = t;
+    }
+    compressBatchRange(&ranges[0]);
+    for (unsigned t = started + 1; t < threads; t++)
+    {
+        compressBatchRange(&ranges[t]);
+    }
+    for (unsigned t = 1; t <= started; t++)
+    {
+        pthread_join(workers[t], NULL);
+    }
+}
+
+void BDICompressBatch(const unsigned char *lines, size_t count, unsigned lineSize, EndianType endianType, CompressionResult *results, unsigned threads)
+{
+    BatchRange whole = {lines, 0, count, lineSize, endianType, results, NULL};
+    compressBatch(whole, count, threads);
+}
+
+void FPCCompressBatch(const unsigned char *lines, size_t count, unsigned lineSize, EndianType endianType, unsigned *sizes, unsigned threads)
+{
+    BatchRange whole = {lines, 0, count, lineSize, endianType, NULL, sizes};
+    compressBatch(whole, count, threads);
+}
 
 void printBuffer(const char *buffer, unsigned size)
 {
@@ -584,7 +1230,7 @@ BufferStruct readHexValuesIntoBuffer(const char *filename)
     return result;
 }
 
-void generateCompressedData(const char *filename, CompressionResult *compResult){
+void generateCompressedData(const char *filename, EndianType endianType, CompressionResult *compResult){
 
     BufferStruct bufferStruct = readHexValuesIntoBuffer(filename);
 
@@ -610,7 +1256,7 @@ void generateCompressedData(const char *filename, CompressionResult *compResult)
     // Call the BDICompress function
     // unsigned compressedSize = GeneralCompress(buffer, bufferSize, 3);
     // CompressionResult *compResult = (CompressionResult*)malloc(sizeof(CompressionResult));
-    (*compResult) = BDICompress(buffer, bufferSize);
+    (*compResult) = BDICompress(buffer, bufferSize, endianType);
 
     // Check the result
     if ((*compResult).compSize == 0)
@@ -2,7 +2,7 @@
  * Original source code: https://github.com/CMU-SAFARI/BDICompression.git
  * 
  * Created by Penggao Li
- * Last modified: 04/27/2024
+ * Last modified: 10/17/2026
  */
 
 #ifndef _BDI_H_
@@ -32,13 +32,15 @@ typedef struct{
     unsigned compSize;
 }CurrCompResult;
 
-// use bdi only
+// K and BaseNum are BDI's, the other compressors leave them 0
 typedef struct {
     unsigned isZero;
     unsigned isSame;
     unsigned compSize;
     unsigned K;
     unsigned BaseNum; 
+    unsigned algorithm;    // Index in compressors[] (compressors.h), 0 (BDI) from BDICompress
+    unsigned stored;       // Kept uncompressed (compSize is the whole line), hits decode nothing
 }CompressionResult;
 
 unsigned long long my_llabs(long long x);
@@ -74,14 +76,79 @@ unsigned doubleExponentCompression(long long unsigned *values, unsigned size, un
 CurrCompResult multBaseCompression(long long unsigned *values, unsigned size, unsigned blimit, unsigned bsize, unsigned base);
 
 // unsigned BDICompress(char *buffer, unsigned _blockSize);
-CompressionResult BDICompress(unsigned char *buffer, unsigned _blockSize);
+CompressionResult BDICompress(unsigned char *buffer, unsigned _blockSize, EndianType endianType);
 
-unsigned FPCCompress(unsigned char *buffer, unsigned size);
+///
+/// Pick the kernel BDICompress checks values with: AVX2 when CPUID reports it, scalar
+/// otherwise or when forceScalar is set. Done once at startup, both give the same results
+///
+void selectBDIKernel(int forceScalar);
+
+const char *BDIKernelName(void);
+
+unsigned FPCCompress(unsigned char *buffer, unsigned size, EndianType endianType);
+
+///
+/// Encodings of BDIEncode, tried smallest payload first. The id is the first byte of
+/// every encoded line and stands for the metadata hardware keeps in the tag store
+///
+typedef enum {
+    BDI_ZEROS,
+    BDI_REPEATED,          // One 8-byte value over the whole line
+    BDI_BASE8_DELTA1,
+    BDI_BASE8_DELTA2,
+    BDI_BASE8_DELTA4,
+    BDI_BASE4_DELTA1,
+    BDI_BASE4_DELTA2,
+    BDI_BASE2_DELTA1,
+    BDI_UNCOMPRESSED,
+    BDI_ENCODINGS
+} BDIEncoding;
+
+const char *BDIEncodingName(BDIEncoding encoding);
 
-// unsigned GeneralCompress(char *buffer, unsigned _blockSize, unsigned compress);
+///
+/// Payload bytes of encoding for lines of lineSize bytes, the id byte excluded. 0 when
+/// the encoding does not apply to that line size
+///
+unsigned BDIPayloadSize(BDIEncoding encoding, unsigned lineSize);
+
+///
+/// Encode line into out (at most lineSize + 1 bytes) with the smallest encoding that
+/// holds it: base + delta payloads are the base, one bit per value choosing it over the
+/// implicit zero base, then a signed delta per value. Returns the bytes written
+///
+unsigned BDIEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out);
+
+///
+/// Rebuild the lineSize bytes of a line from BDIEncode's output. Returns the encoded
+/// bytes consumed, or 0 if encoded does not start with an encoding valid for lineSize
+///
+unsigned BDIDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line);
+
+///
+/// The result BDIEncode achieves on line: compSize is the payload of the encoding it
+/// picks, which BDICompress can undercut since it does not count the base + delta mask
+///
+CompressionResult BDIEncodedResult(const unsigned char *line, unsigned lineSize, EndianType endianType);
+
+///
+/// Compress count lines of lineSize bytes stored back to back in lines: results[i] is
+/// BDICompress of line i. Batches of a few MB or more are split across up to threads
+/// threads, the calling thread included
+///
+void BDICompressBatch(const unsigned char *lines, size_t count, unsigned lineSize, EndianType endianType, CompressionResult *results, unsigned threads);
+
+///
+/// FPCCompress of each of count lines of lineSize bytes (a multiple of 4) into sizes[i]
+///
+void FPCCompressBatch(const unsigned char *lines, size_t count, unsigned lineSize, EndianType endianType, unsigned *sizes, unsigned threads);
 
 BufferStruct readHexValuesIntoBuffer(const char *filename);
 
-void generateCompressedData(const char *filename, CompressionResult *compResult);
+///
+/// Read the hex dump in filename and BDI-compress it, reading values as endianType
+///
+void generateCompressedData(const char *filename, EndianType endianType, CompressionResult *compResult);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,235 @@
+/*
+ * bdiVerify.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bdi.h"
+#include "compressors.h"
+
+#define MIN_TIMED_BYTES (64u << 20) // Timed passes repeat until this much was processed
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// A raw memory image, or a hex dump (one 32-bit word per line) when the name ends in .txt
+static BufferStruct readImage(const char *filename) {
+    size_t length = strlen(filename);
+    if (length > 4 && strcmp(filename + length - 4, ".txt") == 0) {
+        return readHexValuesIntoBuffer(filename);
+    }
+
+    BufferStruct image = {NULL, 0};
+    FILE *file = fopen(filename, "rb");
+    if (file == NULL) {
+        return image;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    image.buffer = malloc(size > 0 ? size : 1);
+    if (image.buffer != NULL && fread(image.buffer, 1, size, file) == (size_t)size) {
+        image.size = size;
+    } else {
+        free(image.buffer);
+        image.buffer = NULL;
+    }
+    fclose(file);
+    return image;
+}
+
+static void printRate(const char *what, double seconds, size_t bytes, size_t lines) {
+    printf("%-7s %8.3f GB/s  %8.1f ns/line\n", what, bytes / seconds * 1e-9, seconds * 1e9 / lines);
+}
+
+// Round-trip the lines through every registered compressor, returns the lines that differ
+static size_t verifyCompressors(const unsigned char *lines, size_t count, unsigned lineSize, EndianType endianType) {
+    size_t stride = MAX_ENCODED_SIZE(lineSize);
+    unsigned char *encoded = malloc(count * stride);
+    unsigned char *decoded = malloc(lineSize);
+    if (encoded == NULL || decoded == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    printf("\n%-10s %10s %8s %8s %10s %10s\n", "Compressor", "Mismatches", "Encoded", "Sized", "Enc GB/s", "Dec GB/s");
+    size_t totalMismatches = 0;
+    for (int c = 0; compressors[c] != NULL; c++) {
+        const Compressor *compressor = compressors[c];
+        size_t encodedBytes = 0;
+        size_t sizedBytes = 0;
+        size_t mismatches = 0;
+        double start = now();
+        for (size_t i = 0; i < count; i++) {
+            encodedBytes += compressor->encode(lines + i * lineSize, lineSize, endianType, encoded + i * stride);
+        }
+        double encodeTime = now() - start;
+        start = now();
+        for (size_t i = 0; i < count; i++) {
+            if (compressor->decode(encoded + i * stride, lineSize, endianType, decoded) == 0
+                || memcmp(decoded, lines + i * lineSize, lineSize) != 0) {
+                mismatches++;
+            }
+        }
+        double decodeTime = now() - start;
+        for (size_t i = 0; i < count; i++) {
+            sizedBytes += compressor->size(lines + i * lineSize, lineSize, endianType).compSize;
+        }
+        printf("%-10s %10zu %8.3f %8.3f %10.3f %10.3f\n", compressor->name, mismatches,
+               (double)count * lineSize / encodedBytes, (double)count * lineSize / sizedBytes,
+               count * lineSize / encodeTime * 1e-9, count * lineSize / decodeTime * 1e-9);
+        totalMismatches += mismatches;
+    }
+
+    free(encoded);
+    free(decoded);
+    return totalMismatches;
+}
+
+// Round-trip every line of the image, compare the encoded sizes with what BDICompress
+// claims and time both directions
+static int verifyImage(const char *filename, unsigned lineSize, EndianType endianType) {
+    BufferStruct image = readImage(filename);
+    if (image.buffer == NULL) {
+        perror(filename);
+        return -1;
+    }
+    size_t count = image.size / lineSize;
+    if (count == 0) {
+        fprintf(stderr, "%s: smaller than one %u-byte line\n", filename, lineSize);
+        free(image.buffer);
+        return -1;
+    }
+
+    // Fixed stride, so line i is encoded at i * stride whatever the sizes
+    size_t stride = lineSize + 1;
+    unsigned char *encoded = malloc(count * stride);
+    unsigned *sizes = malloc(count * sizeof(unsigned));
+    unsigned char *decoded = malloc(lineSize);
+    CompressionResult *claims = malloc(count * sizeof(CompressionResult));
+    size_t *byEncoding = malloc(count * sizeof(size_t));
+    if (encoded == NULL || sizes == NULL || decoded == NULL || claims == NULL || byEncoding == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned passes = MIN_TIMED_BYTES / (count * lineSize) + 1;
+    double start = now();
+    for (unsigned pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            sizes[i] = BDIEncode(image.buffer + i * lineSize, lineSize, endianType, encoded + i * stride);
+        }
+    }
+    double encodeTime = (now() - start) / passes;
+
+    size_t mismatches = 0;
+    start = now();
+    for (unsigned pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            if (BDIDecode(encoded + i * stride, lineSize, endianType, decoded) != sizes[i]
+                || memcmp(decoded, image.buffer + i * lineSize, lineSize) != 0) {
+                mismatches += pass == 0;
+            }
+        }
+    }
+    double decodeTime = (now() - start) / passes;
+
+    BDICompressBatch(image.buffer, count, lineSize, endianType, claims, sysconf(_SC_NPROCESSORS_ONLN));
+
+    printf("\n%s: %zu lines of %u bytes, %s endian, BDI kernel %s\n", filename, count, lineSize,
+           endianType == BIG ? "big" : "little", BDIKernelName());
+    printf("Round trip: %zu of %zu lines differ\n", mismatches, count);
+    printRate("Encode", encodeTime, count * lineSize, count);
+    printRate("Decode", decodeTime, count * lineSize, count);
+
+    // Per encoding: how often it was chosen, what it costs to decode, and how often
+    // BDICompress claimed less than the bytes it really takes
+    printf("\n%-14s %10s %8s %10s %12s %14s\n", "Encoding", "Lines", "Payload", "Decode ns", "Claimed avg", "Under-claimed");
+    size_t encodedBytes = 0;
+    size_t claimedBytes = 0;
+    for (unsigned e = 0; e < BDI_ENCODINGS; e++) {
+        size_t lines = 0;
+        size_t claimed = 0;
+        size_t under = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (encoded[i * stride] == e) {
+                byEncoding[lines++] = i;
+                claimed += claims[i].compSize;
+                under += claims[i].compSize < sizes[i] - 1;
+            }
+        }
+        if (lines == 0) {
+            continue;
+        }
+        unsigned linePasses = MIN_TIMED_BYTES / 4 / (lines * lineSize) + 1;
+        start = now();
+        for (unsigned pass = 0; pass < linePasses; pass++) {
+            for (size_t j = 0; j < lines; j++) {
+                BDIDecode(encoded + byEncoding[j] * stride, lineSize, endianType, decoded);
+            }
+        }
+        double decodeNs = (now() - start) / linePasses / lines * 1e9;
+        unsigned payload = BDIPayloadSize(e, lineSize);
+        encodedBytes += lines * payload;
+        claimedBytes += claimed;
+        printf("%-14s %10zu %8u %10.1f %12.1f %14zu\n", BDIEncodingName(e), lines, payload, decodeNs,
+               (double)claimed / lines, under);
+    }
+    printf("\nCompression ratio: %.3f encoded, %.3f claimed by BDICompress\n",
+           (double)count * lineSize / encodedBytes, (double)count * lineSize / claimedBytes);
+    // Ratios of the encoded bytes (format bytes included) and of the sizes the simulator charges
+    mismatches += verifyCompressors(image.buffer, count, lineSize, endianType);
+
+    free(image.buffer);
+    free(encoded);
+    free(sizes);
+    free(decoded);
+    free(claims);
+    free(byEncoding);
+    return mismatches == 0 ? 0 : -1;
+}
+
+static int usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-l line size] [-e big|little] <memory image or hex .txt>...\n", program);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned lineSize = 64;
+    EndianType endianType = LITTLE;
+    int opt;
+    while ((opt = getopt(argc, argv, "l:e:")) != -1) {
+        switch (opt) {
+            case 'l':
+                lineSize = atoi(optarg);
+                break;
+            case 'e':
+                endianType = strcasecmp(optarg, "big") == 0 ? BIG : LITTLE;
+                break;
+            default:
+                return usage(argv[0]);
+        }
+    }
+    if (optind >= argc || lineSize < 2 || lineSize > 4096) {
+        return usage(argv[0]);
+    }
+
+    int status = EXIT_SUCCESS;
+    for (int i = optind; i < argc; i++) {
+        if (verifyImage(argv[i], lineSize, endianType) != 0) {
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
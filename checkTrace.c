@@ -2,13 +2,15 @@
  * checkTrace.c
  * 
  * Created by Penggao Li
- * Last modified: 04/26/2024
+ * Last modified: 10/17/2026
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 
+#include "traceReader.h"
+
 int main(int argc, char *argv[]) {
     if (argc != 2) {
         fprintf(stderr, "Usage: %s <tracefile>\n", argv[0]);
@@ -16,19 +18,20 @@ int main(int argc, char *argv[]) {
     }
 
     const char *filename = argv[1];
-    FILE *file = fopen(filename, "r");
-    if (!file) {
+    TraceReader reader;
+    if (openTraceReader(&reader, filename) != 0) {
         perror("Error opening file");
         return EXIT_FAILURE;
     }
 
     unsigned long long minAddr = ULLONG_MAX;
     unsigned long long maxAddr = 0;
-    char line[100];
-    unsigned long long addr;
+    TraceRecord record;
+    TraceStatus status;
 
-    while (fgets(line, sizeof(line), file)) {
-        if (sscanf(line, "%*c 0x%llx", &addr) == 1) {
+    while ((status = nextTraceRecord(&reader, &record)) != TRACE_END) {
+        if (status == TRACE_RECORD) {
+            unsigned long long addr = record.address;
             if (addr < minAddr) {
                 minAddr = addr;
             }
@@ -38,7 +41,7 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    fclose(file);
+    closeTraceReader(&reader);
 
     printf("Memory access range: 0x%llx to 0x%llx\n", minAddr, maxAddr);
     if (maxAddr > minAddr) {
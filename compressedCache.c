@@ -2,7 +2,7 @@
  * compressedCache.c
  * 
  * Created by Penggao Li
- * Last modified: 04/29/2024
+ * Last modified: 10/17/2026
  */
 
 #include "compressedCache.h"
@@ -27,50 +27,128 @@ void initializeCacheLine(CompressedCacheLine *line, addr_32_bit tag, Compression
     // printf("\nInitialized cacheline\n");
 }
 
-void initializeCacheSet(CacheSet *set) {
-    // printf("\nInitializing cacheset...\n");
-    set->lines = NULL;
-    set->numberOfLines = 0;
-    set->remainingSize = 64;
-    set->CAMP_hb_count = 0;
-    for(int i = 0; i < 8; i++){
-        set->CAMP_weight_table[i] = i+1;
+int initializeCacheGeometry(CacheGeometry *geometry, unsigned int cacheSizeKB, unsigned int lineSize, unsigned int associativity) {
+    if (lineSize < 4 || lineSize > MAX_LINE_SIZE || (lineSize & (lineSize - 1)) != 0) {
+        fprintf(stderr, "Line size must be a power of two between 4 and %d bytes: %u\n", MAX_LINE_SIZE, lineSize);
+        return -1;
+    }
+    if (associativity == 0 || SLOTS_PER_SET(lineSize * associativity) > MAX_LINES_PER_SET) {
+        fprintf(stderr, "A set of %u x %u-byte lines does not fit in %d slots\n", associativity, lineSize, MAX_LINES_PER_SET);
+        return -1;
+    }
+    unsigned long cacheSize = (unsigned long)cacheSizeKB * 1024;
+    unsigned long setSize = lineSize * associativity;
+    unsigned long numberOfSets = cacheSize / setSize;
+    if (numberOfSets == 0 || numberOfSets * setSize != cacheSize || (numberOfSets & (numberOfSets - 1)) != 0) {
+        fprintf(stderr, "%u KB is not a power-of-two number of %lu-byte sets\n", cacheSizeKB, setSize);
+        return -1;
     }
-    for(int i = 0; i < 16; i++){
-        set->CAMP_history_buffer[i] = 0;
+    geometry->offsetBits = __builtin_ctz(lineSize);
+    geometry->indexBits = __builtin_ctzl(numberOfSets);
+    if (geometry->offsetBits + geometry->indexBits >= 32) {
+        fprintf(stderr, "%u KB leaves no tag bits in a 32-bit address\n", cacheSizeKB);
+        return -1;
     }
+    geometry->cacheSizeKB = cacheSizeKB;
+    geometry->lineSize = lineSize;
+    geometry->associativity = associativity;
+    geometry->numberOfSets = numberOfSets;
+    geometry->setSize = setSize;
+    geometry->linesPerSet = SLOTS_PER_SET(setSize);
+    return 0;
+}
+
+void initializeCacheSet(CacheSet *set, const CacheGeometry *geometry) {
+    // printf("\nInitializing cacheset...\n");
+    set->validMask = 0;
+    set->clock = 0;
+    set->numberOfLines = 0;
+    set->remainingSize = geometry->setSize;
     // printf("\nInitialize cacheset complete\n");
 }
 
 void freeCacheSet(CacheSet *set) {
     // printf("\nFreeing cacheset...\n");
-    if (set->lines != NULL) {
-        free(set->lines);  // Free the lines
-        set->lines = NULL;
-    }
+    set->validMask = 0;  // Slots live in the cache's pools, freed by freeCache
     set->numberOfLines = 0;
-    set->remainingSize = LINE_SIZE * SET_ASSOCIATIVITY;
-    set->CAMP_hb_count = 0;
+    set->remainingSize = 0;
     // printf("\nFreed cacheset\n");
 }
 
-void initializeCache(Cache *cache) {
+static void *allocateCachePool(size_t count, size_t size) {
+    // Rounded up to the alignment so that aligned_alloc accepts every pool size
+    void *pool = aligned_alloc(32, (count * size + 31) & ~(size_t)31);
+    if (pool == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    memset(pool, 0, count * size);
+    return pool;
+}
+
+void initializeCache(Cache *cache, const CacheGeometry *geometry, const ReplacementPolicy *policy) {
     //printf("\nInitializing cache...\n");
-    for (int i = 0; i < NUMBER_OF_SETS; i++) {
-        initializeCacheSet(&(cache->sets[i]));
+    cache->geometry = *geometry;
+    cache->policy = policy;
+    size_t slots = (size_t)geometry->numberOfSets * geometry->linesPerSet;
+    cache->sets = allocateCachePool(geometry->numberOfSets, sizeof(CacheSet));
+    cache->tagPool = allocateCachePool(slots, sizeof(addr_32_bit));
+    cache->lastAccessPool = allocateCachePool(slots, sizeof(unsigned long));
+    cache->rrvpPool = allocateCachePool(slots, sizeof(unsigned char));
+    cache->sizePool = allocateCachePool(slots, sizeof(unsigned short));
+    cache->compResultPool = allocateCachePool(slots, sizeof(CompressionResult));
+    for (unsigned int i = 0; i < geometry->numberOfSets; i++) {
+        CacheSet *set = &(cache->sets[i]);
+        size_t first = (size_t)i * geometry->linesPerSet;
+        set->tags = &(cache->tagPool[first]);
+        set->lastAccess = &(cache->lastAccessPool[first]);
+        set->rrvp = &(cache->rrvpPool[first]);
+        set->sizes = &(cache->sizePool[first]);
+        set->compResults = &(cache->compResultPool[first]);
+        initializeCacheSet(set, geometry);
     }
-    cache->CAMP_training_counter = 160;
+    for(int i = 0; i < CAMP_SIZE_CLASSES; i++){
+        cache->CAMP_weight_table[i] = i+1;
+    }
+    cache->policyState = policy->createState != NULL ? policy->createState(geometry) : NULL;
     //printf("\nInitialize cache complete\n");
 }
 
 void freeCache(Cache *cache) {
     // printf("\nFreeing cache...\n");
-    for (int i = 0; i < NUMBER_OF_SETS; i++) {
+    for (unsigned int i = 0; i < cache->geometry.numberOfSets; i++) {
         freeCacheSet(&(cache->sets[i]));
     }
+    free(cache->tagPool);
+    free(cache->lastAccessPool);
+    free(cache->rrvpPool);
+    free(cache->sizePool);
+    free(cache->compResultPool);
+    free(cache->sets);
+    if (cache->policy->freeState != NULL) {
+        cache->policy->freeState(cache->policyState);
+    } else {
+        free(cache->policyState);
+    }
+    cache->sets = NULL;
+    cache->policyState = NULL;
     // printf("\nFreed cache\n");
 }
 
+void initializeSimContext(SimContext *ctx, Cache *cache, unsigned long seed, CompressionResult *compResult, unsigned int compResultCount) {
+    ctx->cache = cache;
+    ctx->policy = cache->policy;
+    ctx->seed = seed;
+    ctx->compResult = compResult;
+    ctx->compResultCount = compResultCount;
+    memset(&(ctx->stats), 0, sizeof(ctx->stats));
+    memset(&(ctx->out), 0, sizeof(ctx->out));
+    ctx->shardBegin = 0;
+    ctx->shardEnd = cache->geometry.numberOfSets;
+    ctx->epoch = POLICY_EPOCH;
+    memset(ctx->policyCounters, 0, sizeof(ctx->policyCounters));
+}
+
 
 /* =====================================================================================
  * 
@@ -79,72 +157,103 @@ void freeCache(Cache *cache) {
  * =====================================================================================
  */
 
+// Split an address for a cache with 2^offsetBits-byte lines and 2^indexBits sets
+static inline __attribute__((always_inline)) AddressParts splitAddress(addr_32_bit address, unsigned int offsetBits, unsigned int indexBits) {
+    AddressParts parts;
+    parts.offset = address & ((1u << offsetBits) - 1);
+    parts.index = (address >> offsetBits) & ((1u << indexBits) - 1);
+    parts.tag = address >> (offsetBits + indexBits);
+    return parts;
+}
+
+// Bit i of the result is set when tags[i] equals tag, free slots are not masked out.
+// linesPerSet is a multiple of 8, and a constant in the specialized kernels so the loop unrolls
+static inline __attribute__((always_inline)) uint64_t matchTag(const CacheSet *set, addr_32_bit tag, unsigned int linesPerSet){
+    uint64_t mask = 0;
+#if defined(__AVX2__)
+    __m256i key = _mm256_set1_epi32((int)tag);
+    for(unsigned int i = 0; i < linesPerSet; i += 8){
+        __m256i tags = _mm256_load_si256((const __m256i *)&(set->tags[i]));
+        __m256i eq = _mm256_cmpeq_epi32(tags, key);
+        mask |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) << i;
+    }
+#elif defined(__SSE2__)
+    __m128i key = _mm_set1_epi32((int)tag);
+    for(unsigned int i = 0; i < linesPerSet; i += 4){
+        __m128i tags = _mm_load_si128((const __m128i *)&(set->tags[i]));
+        __m128i eq = _mm_cmpeq_epi32(tags, key);
+        mask |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(eq)) << i;
+    }
+#else
+    for(unsigned int i = 0; i < linesPerSet; i++){
+        mask |= (uint64_t)(set->tags[i] == tag) << i;
+    }
+#endif
+    return mask;
+}
+
 int addLineToCacheSet(CacheSet *set, CompressedCacheLine *line) {
     // printf("\nAdding new line to cacheset...\n");
-    if (set->remainingSize >= line->roundedCompSize) {
-        // Ensure enough space
-        set->lines = realloc(set->lines, (set->numberOfLines + 1) * sizeof(CompressedCacheLine));
-        if (set->lines == NULL) {
-            return -1; // Memory allocation failed
-        }
-        set->lines[set->numberOfLines] = *line; // Copy the line into the set
+    if (set->remainingSize >= line->roundedCompSize && ~set->validMask != 0) {
+        // Lines are at least 4 bytes, so a free slot exists whenever the space does
+        int slot = __builtin_ctzll(~set->validMask);
+        // Scatter the line into the per-field arrays of the set
+        set->tags[slot] = line->tag;
+        set->lastAccess[slot] = set->clock - line->timestamp;
+        set->rrvp[slot] = line->rrvp;
+        set->sizes[slot] = line->roundedCompSize;
+        set->compResults[slot] = line->compResult;
+        set->validMask |= 1ULL << slot;
         set->numberOfLines++;
         set->remainingSize -= line->roundedCompSize; // Decrease remaining size
         // printf("\nNew line added.\n");
-        return 0; // Success
+        return slot; // Success
     }
     return -1; // Not enough space
 }
 
-bool addLineToCacheSetWithRP(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv){
+bool addLineToCacheSetWithRP(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
+
+    const ReplacementPolicy *policy = ctx->policy;
+    int slot = addLineToCacheSet(set, line);
 
-    if(addLineToCacheSet(set, line) == -1){
+    if(slot == -1){
 
         info->ifEvict = 1;
 
-        switch(RP){
-            case RANDOM:
-            randomEvict(set, line, info, csv);
-            break;
-            case BESTFIT:
-            bestfitEvict(set, line, info, csv);
-            break;
-            case LRU:
-            LRUEvict(set, line, info, csv);
-            break;
-            case CAMP:
-            CAMPEvict(set, line, info, csv);
-            break;
-            default:
-            randomEvict(set, line, info, csv);
-            break;
-        }
-        if(addLineToCacheSet(set, line) == 0){
-
-            info->ifEvict = 0;
-
-            return true;
-        }else{
+        makeRoomInCacheSet(policy, ctx, set, line, info);
+        slot = addLineToCacheSet(set, line);
+        if(slot == -1){
             perror("ERROR adding new line!!!");
             return false;
         }
     }
 
     info->ifEvict = 0;
+    if(policy->insert != NULL){
+        policy->insert(ctx, set, slot);
+    }
 
     return true;
 }
 
+void makeRoomInCacheSet(const ReplacementPolicy *policy, SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
+    if(policy->evict != NULL){
+        policy->evict(ctx, set, line, info);
+        return;
+    }
+    OutputInfo evictInfo = *info;
+    while(set->remainingSize < line->roundedCompSize && set->numberOfLines > 0){
+        evictLineFromCacheSet(ctx, set, policy->victim(ctx, set, line), &evictInfo);
+    }
+}
+
 void removeLineFromCacheSet(CacheSet *set, addr_32_bit tag) {
     // printf("\nRemoving a line from cacheset...\n");
-    for(int i = 0; i < set->numberOfLines; i++){
-        if(set->lines[i].tag == tag){
-            set->remainingSize += set->lines[i].roundedCompSize; // Reclaim the space
-            // Move the last line to the removed spot to keep array compact
-            if(i != set->numberOfLines - 1){
-                set->lines[i] = set->lines[set->numberOfLines - 1];
-            }
-            set->numberOfLines--;
+    for(uint64_t used = usedSlots(set); used != 0; used &= used - 1){
+        int i = __builtin_ctzll(used);
+        if(set->tags[i] == tag){
+            removeLineFromCacheSetBySlot(set, i);
             // printf("\nRemoved a line from cacheset\n");
             return;
         }
@@ -152,151 +261,141 @@ void removeLineFromCacheSet(CacheSet *set, addr_32_bit tag) {
     // printf("\nTry to removed a line BUT NOT FOUND!!!\n");
 }
 
-void removeLineFromCacheSetBySize(CacheSet *set, unsigned int size, OutputInfo *evictInfo) {
-    // printf("\nRemoving a line from cacheset...\n");
-    for(int i = 0; i < set->numberOfLines; i++){
-        if(set->lines[i].roundedCompSize == size){
+void removeLineFromCacheSetBySlot(CacheSet *set, int slot) {
+    set->remainingSize += set->sizes[slot]; // Reclaim the space
+    set->validMask &= ~(1ULL << slot);
+    set->numberOfLines--;
+}
 
-            evictInfo->compResult = set->lines[i].compResult;
-            evictInfo->roundedCompSize = set->lines[i].roundedCompSize;
-            evictInfo->timestamp = set->lines[i].timestamp;
+void evictLineFromCacheSet(SimContext *ctx, CacheSet *set, int slot, OutputInfo *evictInfo) {
+    evictInfo->compResult = set->compResults[slot];
+    evictInfo->roundedCompSize = set->sizes[slot];
+    evictInfo->timestamp = lineAge(set, slot);
 
-            set->remainingSize += set->lines[i].roundedCompSize; // Reclaim the space
-            // Move the last line to the removed spot to keep array compact
-            if(i != set->numberOfLines - 1){
-                set->lines[i] = set->lines[set->numberOfLines - 1];
-            }
-            set->numberOfLines--;
+    removeLineFromCacheSetBySlot(set, slot);
 
-            // printf("\nRemoved cacheline size: %d\n", size);
-            return;
-        }
-    }
-    // printf("\nTry to removed a line by size BUT NOT FOUND!!!\n");
+    writeOutputInfo(&(ctx->out), evictInfo);
 }
 
-void removeLineFromCacheSetByTime(CacheSet *set, unsigned long timestamp, OutputInfo *evictInfo) {
+void removeLineFromCacheSetBySize(CacheSet *set, unsigned int size, OutputInfo *evictInfo) {
     // printf("\nRemoving a line from cacheset...\n");
-    unsigned int size = 0;
-    for(int i = 0; i < set->numberOfLines; i++){
-        if(set->lines[i].timestamp == timestamp){
-
-            evictInfo->compResult = set->lines[i].compResult;
-            evictInfo->roundedCompSize = set->lines[i].roundedCompSize;
-            evictInfo->timestamp = set->lines[i].timestamp;
-
-            size = set->lines[i].roundedCompSize;
-            set->remainingSize += size; // Reclaim the space
-            // Move the last line to the removed spot to keep array compact
-            if(i != set->numberOfLines - 1){
-                set->lines[i] = set->lines[set->numberOfLines - 1];
-            }
-            set->numberOfLines--;
+    for(uint64_t used = usedSlots(set); used != 0; used &= used - 1){
+        int i = __builtin_ctzll(used);
+        if(set->sizes[i] == size){
 
-            // printf("\nRemoved cacheline size: %d, timestamp: %ld\n", size, timestamp);
+            evictInfo->compResult = set->compResults[i];
+            evictInfo->roundedCompSize = set->sizes[i];
+            evictInfo->timestamp = lineAge(set, i);
+
+            removeLineFromCacheSetBySlot(set, i);
+
+            // printf("\nRemoved cacheline size: %d\n", size);
             return;
         }
     }
     // printf("\nTry to removed a line by size BUT NOT FOUND!!!\n");
 }
 
-bool ifHit(Cache *cache, addr_32_bit addr, OutputInfo *info){
+// Lookup shared by every simulation kernel: the shape parameters are compile-time
+// constants in the specialized kernels and loads from cache->geometry otherwise
+static inline __attribute__((always_inline)) bool ifHitShaped(SimContext *ctx, addr_32_bit addr, OutputInfo *info, unsigned int offsetBits, unsigned int indexBits, unsigned int linesPerSet){
 
-    AddressParts parts = extractAddressParts(addr);
+    AddressParts parts = splitAddress(addr, offsetBits, indexBits);
     // printf("Address: 0x%X\nTag: 0x%X\nIndex: %u\nOffset: %u\n",
         //    addr, parts.tag, parts.index, parts.offset);
 
-    CacheSet set = cache->sets[parts.index];
+    CacheSet *set = &(ctx->cache->sets[parts.index]);
+
+    uint64_t hit = matchTag(set, parts.tag, linesPerSet) & usedSlots(set);
 
-    bool flag = false;
+    // One tick per lookup of this set, a line's age is the ticks since its last access
+    set->clock++;
 
-    if(set.lines == NULL || set.numberOfLines == 0){
+    if(hit == 0){
         return false;
     }
 
-    for(int i = 0; i < set.numberOfLines; i++){
-        if(set.lines[i].tag == parts.tag){
+    int i = __builtin_ctzll(hit);
 
-            info->compResult = set.lines[i].compResult;
-            info->ifEvict = 0;
-            info->ifHit = 1;
-            info->roundedCompSize = set.lines[i].roundedCompSize;
-            info->timestamp = set.lines[i].timestamp;
+    info->compResult = set->compResults[i];
+    info->ifEvict = 0;
+    info->ifHit = 1;
+    info->roundedCompSize = set->sizes[i];
+    info->timestamp = lineAge(set, i) - 1;  // Not counting this lookup
 
-            flag = true;
-            set.lines[i].timestamp = 0;
-            updateCamp(&(cache->sets[parts.index]), set.lines[i].roundedCompSize);
-            if(set.lines[i].rrvp != 0) set.lines[i].rrvp -= 1;
-        }else{
-            set.lines[i].timestamp++;
-        }
+    set->lastAccess[i] = set->clock;
+    if(ctx->policy->hit != NULL){
+        ctx->policy->hit(ctx, set, i);
     }
-    return flag;
+
+    return true;
 }
 
-void cachingByAddrAndRandomMemContent(Cache *cache, CompressionResult *compResultArr, addr_32_bit addr, char operation, FILE *csv){
+bool ifHit(SimContext *ctx, addr_32_bit addr, OutputInfo *info){
+    const CacheGeometry *geometry = &(ctx->cache->geometry);
+    return ifHitShaped(ctx, addr, info, geometry->offsetBits, geometry->indexBits, geometry->linesPerSet);
+}
+
+// Miss path, kept out of the kernels so that their hit loop stays small
+static void insertMissLine(SimContext *ctx, AddressParts parts, unsigned long recordIndex, OutputInfo *info){
+
+    info->ifHit = 0;
+
+    // Keyed by the record, not drawn in simulation order, so caches and shards agree
+    int randomNum = drawRandom(ctx->seed ^ (0x9E3779B97F4A7C15ULL * (recordIndex + 1)), ctx->compResultCount);
+    CompressionResult compResult = ctx->compResult[randomNum];
+
+    info->compResult = compResult;
+    
+    // Copied into a slot of the set, so the miss path never touches the heap
+    CompressedCacheLine newLine;
+    initializeCacheLine(&newLine, parts.tag, compResult);
+
+    info->roundedCompSize = newLine.roundedCompSize;
+    info->timestamp = 0;
+    
+    addLineToCacheSetWithRP(ctx, &(ctx->cache->sets[parts.index]), &newLine, info);
+
+    writeOutputInfo(&(ctx->out), info);
+
+    // printCacheLineInfo((*cache).sets[parts.index].lines);
+    // printf("\n-- [Cacheset left: %d, num: %d] --\n\n", (*cache).sets[parts.index].remainingSize, (*cache).sets[parts.index].numberOfLines);
+}
+
+static inline __attribute__((always_inline)) void cachingShaped(SimContext *ctx, addr_32_bit addr, char operation, unsigned long recordIndex, unsigned int offsetBits, unsigned int indexBits, unsigned int linesPerSet){
 
     OutputInfo info;
     info.address = addr;
-    char *outputInfo = NULL;
+    info.operation = operation;
+    ctx->record = recordIndex;
 
-    if(ifHit(cache, addr, &info)){
+    if(ifHitShaped(ctx, addr, &info, offsetBits, indexBits, linesPerSet)){
 
         if(operation == 'l'){
-            loadHitCount++;
+            ctx->stats.loadHitCount++;
         }else if(operation == 's'){
-            storeHitCount++;
+            ctx->stats.storeHitCount++;
         }
 
-        outputInfo = generateOutputInfo(info);
-        fprintf(csv, "%s", outputInfo);
-        free(outputInfo);
-        outputInfo = NULL;
+        writeOutputInfo(&(ctx->out), &info);
 
         // printf("\n[HIT]!!!!!\n");
         return;
     }
 
-    info.ifHit = 0;
-
-    AddressParts parts = extractAddressParts(addr);
-    // printf("Address: 0x%X\nTag: 0x%X\nIndex: %u\nOffset: %u\n",
-    //        addr, parts.tag, parts.index, parts.offset);
-
-    int randomNum = generateRandom(5);
-    CompressionResult compResult = compResultArr[randomNum];
-
-    info.compResult = compResult;
-    
-    CompressedCacheLine *newLine = (CompressedCacheLine *)malloc(sizeof(CompressedCacheLine));
-    initializeCacheLine(newLine, parts.tag, compResult);
-
-    info.roundedCompSize = newLine->roundedCompSize;
-    info.timestamp = 0;
-    
-    addLineToCacheSetWithRP(&((*cache).sets[parts.index]), newLine, &info, csv);
-
-    outputInfo = generateOutputInfo(info);
-    fprintf(csv, "%s", outputInfo);
-    free(outputInfo);
-    outputInfo = NULL;
+    insertMissLine(ctx, splitAddress(addr, offsetBits, indexBits), recordIndex, &info);
+}
 
-    // printCacheLineInfo((*cache).sets[parts.index].lines);
-    // printf("\n-- [Cacheset left: %d, num: %d] --\n\n", (*cache).sets[parts.index].remainingSize, (*cache).sets[parts.index].numberOfLines);
+void cachingByAddrAndRandomMemContent(SimContext *ctx, addr_32_bit addr, char operation, unsigned long recordIndex){
+    const CacheGeometry *geometry = &(ctx->cache->geometry);
+    cachingShaped(ctx, addr, operation, recordIndex, geometry->offsetBits, geometry->indexBits, geometry->linesPerSet);
 }
 
-void updateCamp(CacheSet *set, int size){
-    if(set->CAMP_hb_count == 16) {
-        printf("history full\n");
-        return;
+void updateCamp(SimContext *ctx, int size){
+    int sizeClass = size / 4;
+    if(sizeClass > 0){
+        ctx->policyCounters[sizeClass - 1]++;
     }
-    int setCount = set->CAMP_hb_count;
-    set->CAMP_history_buffer[setCount] = size;
-    set->CAMP_hb_count = setCount + 1;
-    if(set->CAMP_hb_count == 16){
-        set->CAMP_hb_count = 0;
-    }
-    return;
 }
 
 /* =====================================================================================
@@ -307,92 +406,53 @@ void updateCamp(CacheSet *set, int size){
  */
 
 // Extract tag, index, and offset from 32-bit address
-AddressParts extractAddressParts(addr_32_bit address) {
-    AddressParts parts;
-    parts.offset = address & 0x1F;
-    parts.index = (address >> 5) & 0x1FF;
-    parts.tag = address >> 14;
-    return parts;
-}
-
-void dfs(unsigned int* nums, int size, int goal, int start, int sum, double evictedIndex) {
-
-    // printf("\nDFS called. Sum: %d\n", sum);
-
-    if (sum - goal < diff && goal <= sum) {
-        diff = sum - goal;
-        closest = evictedIndex;
-    }
-    for (int i = start; i < size; ++i) {
-        dfs(nums, size, goal, i + 1, sum + nums[i], evictedIndex * 100 + nums[i]);
-    }
+AddressParts extractAddressParts(const CacheGeometry *geometry, addr_32_bit address) {
+    return splitAddress(address, geometry->offsetBits, geometry->indexBits);
 }
 
-void minDifference(unsigned int* nums, int size, int goal) {
-
-    // printf("\n[Start DFS for goal: %d]\n", goal);
-
-    if (size == 0) {
-        return;
-    }
-
-    dfs(nums, size, goal, 0, 0, 0);
-}
-
-void doubleToIntegerArray(double value, int **array, int *size) {
-    // Temporary buffer to hold the integer part of the double as a string
-    char buffer[30];
-    
-    // Convert double to string, ignoring the decimal part
-    sprintf(buffer, "%.0f", value);
-    
-    // Determine the size of the array
-    int len = strlen(buffer);
-    *size = (len + 1) / 2;  // Calculate number of integer pairs, rounding up if odd
-    *array = (int *)malloc(*size * sizeof(int));
-    if (*array == NULL) {
-        perror("Memory allocation failed");
-        exit(EXIT_FAILURE);
-    }
-
-    // Initialize the array index and start from the end of the string
-    int index = 0;
-    for (int i = len - 1; i >= 0; i -= 2) {
-        // Check if it's the last single digit
-        if (i == 0) {
-            (*array)[index++] = buffer[i] - '0';  // Convert char to int
-        } else {
-            // Process two digits at a time
-            (*array)[index++] = (buffer[i - 1] - '0') * 10 + (buffer[i] - '0');
+int selectBestfitVictims(const unsigned int *quanta, int count, unsigned int goal, int *victims) {
+    // reachable[i] bit s-1: some non-empty subset of quanta[i..count) sums to s.
+    // A set holds at most 64 quanta in total, so every sum fits one word
+    uint64_t reachable[MAX_LINES_PER_SET + 1];
+    reachable[count] = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        unsigned int q = quanta[i];
+        reachable[i] = reachable[i + 1];
+        if (q > 0) {
+            reachable[i] |= (1ULL << (q - 1)) | (reachable[i + 1] << q);
         }
     }
 
-    for (int i = 0; i < *size / 2; i++) {
-        int temp = (*array)[i];
-        (*array)[i] = (*array)[*size - i - 1];
-        (*array)[*size - i - 1] = temp;
+    // Smallest sum that frees enough space
+    uint64_t candidates = goal <= 1 ? reachable[0] : (goal > 64 ? 0 : reachable[0] & (~0ULL << (goal - 1)));
+    if (candidates == 0) {
+        return 0;
     }
-}
-
-// Descending
-void bubbleSort(unsigned long arr[], int n) {
-    int i, j;
-    unsigned long temp;
-    for (i = 0; i < n - 1; i++) {
-        // Last i elements are already in place
-        for (j = 0; j < n - i - 1; j++) {
-            if (arr[j] < arr[j + 1]) {
-                temp = arr[j];
-                arr[j] = arr[j + 1];
-                arr[j + 1] = temp;
-            }
+    unsigned int left = __builtin_ctzll(candidates) + 1;
+
+    // Take every line that still leaves the rest reachable: the lowest slots win ties,
+    // as in the first-found subset of an exhaustive search in slot order
+    int victimCount = 0;
+    for (int i = 0; i < count && left > 0; i++) {
+        unsigned int q = quanta[i];
+        if (q == 0 || q > left) {
+            continue;
+        }
+        if (q == left || (reachable[i + 1] >> (left - q - 1)) & 1) {
+            victims[victimCount++] = i;
+            left -= q;
         }
     }
+    return victimCount;
 }
 
-int generateRandom(int range){
-    srand(time(0) + rand());
-    return rand() % range;
+// splitmix64 finalizer: nearby keys give unrelated results, no state is kept between calls.
+// The high 32 bits are scaled into [0, range) with a multiply instead of a division
+int drawRandom(uint64_t key, int range){
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return (int)(((key >> 32) * (uint64_t)range) >> 32);
 }
 
 void printCacheLineInfo(CompressedCacheLine *line) {
@@ -412,27 +472,129 @@ void printCacheLineInfo(CompressedCacheLine *line) {
     printf("  - Comp Size: %u\n", line->compResult.compSize);
     printf("  - K: %u\n", line->compResult.K);
     printf("  - BaseNum: %u\n", line->compResult.BaseNum);
+    printf("  - Compressor: %s\n", compressors[line->compResult.algorithm]->name);
     printf("Timestamp: %ld\n", line->timestamp);
     printf("RRVP: %d\n", line->rrvp);
     printf("================================================\n");
 }
 
-void printSimResult(const char *filename){
-    double loadHitRate = ((double)loadHitCount)/((double)loadCount);
-    double storeHitRate = ((double)storeHitCount)/((double)storeCount);
-    double totalHitRate = ((double)(loadHitCount + storeHitCount))/((double)instructionCount);
+static void printSizeHistogram(const char *label, const unsigned long *histogram) {
+    printf("%s", label);
+    for (int i = 0; i < SUMMARY_SIZE_BUCKETS; i++) {
+        if (histogram[i] != 0) {
+            printf(" %dB:%lu", i * 4, histogram[i]);
+        }
+    }
+    printf("\n");
+}
+
+// Lines left in the cache against the lines an uncompressed cache of the same size holds,
+// split by the compressor that sized them
+static void printResidentLines(const SimContext *ctx) {
+    const SimSummary *summary = &(ctx->stats.summary);
+    const CacheGeometry *geometry = &(ctx->cache->geometry);
+    unsigned long resident = 0;
+    for (int i = 0; i < COMPRESSORS; i++) {
+        resident += summary->insertedBy[i] - summary->evictedBy[i];
+    }
+    unsigned long uncompressedLines = (unsigned long)geometry->cacheSizeKB * 1024 / geometry->lineSize;
+    printf("Resident lines: %lu, %.3fx an uncompressed cache (", resident, (double)resident / uncompressedLines);
+    const char *separator = "";
+    for (int i = 0; i < COMPRESSORS; i++) {
+        if (summary->insertedBy[i] != 0) {
+            printf("%s%s:%lu", separator, compressors[i]->name, summary->insertedBy[i] - summary->evictedBy[i]);
+            separator = " ";
+        }
+    }
+    printf(")\n");
+}
+
+// Decompression latency of the hits and of the lines left in the cache, from the
+// decodeCycles of the compressor that sized each line. Lines it kept uncompressed cost 0
+static void printDecodeLatency(const SimContext *ctx) {
+    const SimSummary *summary = &(ctx->stats.summary);
+    unsigned long hits = 0;
+    unsigned long storedHits = 0;
+    unsigned long hitCycles = 0;
+    unsigned long resident = 0;
+    unsigned long storedResident = 0;
+    unsigned long residentCycles = 0;
+    for (int i = 0; i < COMPRESSORS; i++) {
+        unsigned long lines = summary->insertedBy[i] - summary->evictedBy[i];
+        unsigned long storedLines = summary->storedInsertedBy[i] - summary->storedEvictedBy[i];
+        hits += summary->hitsBy[i];
+        storedHits += summary->storedHitsBy[i];
+        hitCycles += (summary->hitsBy[i] - summary->storedHitsBy[i]) * compressors[i]->decodeCycles;
+        resident += lines;
+        storedResident += storedLines;
+        residentCycles += (lines - storedLines) * compressors[i]->decodeCycles;
+    }
+    printf("Decode latency: %.3f cycles per hit, %.3f per resident line (uncompressed: %lu hits, %lu lines)\n",
+           hits == 0 ? 0.0 : (double)hitCycles / hits, resident == 0 ? 0.0 : (double)residentCycles / resident,
+           storedHits, storedResident);
+}
+
+void printSimResult(const SimContext *ctx, const char *filename){
+    const SimStats *stats = &(ctx->stats);
+    const CacheGeometry *geometry = &(ctx->cache->geometry);
+    double loadHitRate = ((double)stats->loadHitCount)/((double)stats->loadCount);
+    double storeHitRate = ((double)stats->storeHitCount)/((double)stats->storeCount);
+    double totalHitRate = ((double)(stats->loadHitCount + stats->storeHitCount))/((double)stats->instructionCount);
     printf("\n\n==========================================================\n");
     printf("File: %s\n", filename);
-    printf("Instructions: %ld\n", instructionCount);
-    printf("        Load: %ld\n", loadCount);
-    printf("       Store: %ld\n", storeCount);
+    printf("Cache: %u KB, %u-byte lines, %u-way\n", geometry->cacheSizeKB, geometry->lineSize, geometry->associativity);
+    printf("Seed: %lu\n", ctx->seed);
+    printf("Instructions: %ld\n", stats->instructionCount);
+    printf("        Load: %ld\n", stats->loadCount);
+    printf("       Store: %ld\n", stats->storeCount);
     printf("----------------------------------------------------------\n");
     printf(" loadHitRate: %f\n", loadHitRate);
     printf("StoreHitRate: %f\n", storeHitRate);
     printf("TotalHitRate: %f\n", totalHitRate);
+    printf("----------------------------------------------------------\n");
+    printf("  Load hit/miss: %ld / %ld\n", stats->loadHitCount, stats->loadCount - stats->loadHitCount);
+    printf(" Store hit/miss: %ld / %ld\n", stats->storeHitCount, stats->storeCount - stats->storeHitCount);
+    printf("Evictions (%s): %lu\n", ctx->policy->name, stats->summary.evictions);
+    printSizeHistogram("Inserted sizes:", stats->summary.insertedSize);
+    printSizeHistogram(" Evicted sizes:", stats->summary.evictedSize);
+    printResidentLines(ctx);
+    printDecodeLatency(ctx);
+    printf("Victims/miss:  ");
+    for (int i = 0; i < SUMMARY_VICTIM_BUCKETS; i++) {
+        if (stats->summary.victimsPerMiss[i] != 0) {
+            printf(" %d:%lu", i, stats->summary.victimsPerMiss[i]);
+        }
+    }
+    printf("\nVictim age:    ");
+    for (int i = 0; i < SUMMARY_AGE_BUCKETS; i++) {
+        if (stats->summary.victimAge[i] == 0) {
+            continue;
+        }
+        if (i < 2) {
+            printf(" %d:%lu", i, stats->summary.victimAge[i]);
+        } else {
+            printf(" %lu-%lu:%lu", 1UL << (i - 1), (1UL << i) - 1, stats->summary.victimAge[i]);
+        }
+    }
+    printf("\n");
+    if (ctx->policy->report != NULL) {
+        ctx->policy->report(ctx->cache);
+    }
     printf("==========================================================\n");
 }
 
+void printMissRatioCurve(const SimContext *contexts, unsigned int contextCount){
+    printf("\nMiss ratio curve (%s):\n", contexts[0].policy->name);
+    printf("   Size   Line  Ways     Misses  MissRate\n");
+    for (unsigned int c = 0; c < contextCount; c++) {
+        const SimStats *stats = &(contexts[c].stats);
+        const CacheGeometry *geometry = &(contexts[c].cache->geometry);
+        long misses = stats->loadCount + stats->storeCount - stats->loadHitCount - stats->storeHitCount;
+        printf("%5uKB %6u %5u %10ld  %f\n", geometry->cacheSizeKB, geometry->lineSize, geometry->associativity,
+               misses, (double)misses / (double)stats->instructionCount);
+    }
+}
+
 /* =====================================================================================
  * 
  *                           Cache replacement functions
@@ -440,173 +602,166 @@ void printSimResult(const char *filename){
  * =====================================================================================
  */
 
-ReplacementPolicy chooseReplacementPolicy() {
-    int choice;
+// CAMP's hits feed its size histogram and lower the line's re-reference value
+static void campHit(SimContext *ctx, CacheSet *set, int slot) {
+    updateCamp(ctx, set->sizes[slot]);
+    if(set->rrvp[slot] != 0) set->rrvp[slot] -= 1;
+}
+
+const ReplacementPolicy randomPolicy = {.name = "random", .evict = randomEvict};
+const ReplacementPolicy bestfitPolicy = {.name = "bestfit", .evict = bestfitEvict};
+const ReplacementPolicy lruPolicy = {.name = "lru", .evict = LRUEvict};
+const ReplacementPolicy campPolicy = {.name = "camp", .evict = CAMPEvict, .hit = campHit, .tick = CAMPWeightUpdate};
+
+const ReplacementPolicy *const replacementPolicies[] = {
+    &randomPolicy, &bestfitPolicy, &lruPolicy, &campPolicy,
+    &srripPolicy, &drripPolicy, &sipPolicy, &ecmPolicy,
+    &adaptivePolicy, &optPolicy,
+    NULL
+};
+
+const ReplacementPolicy *chooseReplacementPolicy() {
+    int choice = 0;
+    int count = 0;
     printf("\nSelect a replacement policy:\n");
-    printf("1. RANDOM\n");
-    printf("2. BESTFIT\n");
-    printf("3. LRU\n");
-    printf("4. CAMP\n");
-    printf("Enter your choice (1-4): ");
+    for (; replacementPolicies[count] != NULL; count++) {
+        printf("%d. %s\n", count + 1, replacementPolicies[count]->name);
+    }
+    printf("Enter your choice (1-%d): ", count);
     scanf("%d", &choice);
 
-    switch (choice) {
-        case 1:
-        printf("Using replacement policy: RANDOM\n");
-        return RANDOM;
-        case 2:
-        printf("Using replacement policy: BESTFIT\n");
-        return BESTFIT;
-        case 3:
-        printf("Using replacement policy: LRU\n");
-        return LRU;
-        case 4:
-        printf("Using replacement policy: CAMP\n");
-        return CAMP;
-        default:
-            printf("Invalid choice, defaulting to LRU.\n");
-            return LRU;
+    if (choice < 1 || choice > count) {
+        printf("Invalid choice, defaulting to lru.\n");
+        return &lruPolicy;
+    }
+    printf("Using replacement policy: %s\n", replacementPolicies[choice - 1]->name);
+    return replacementPolicies[choice - 1];
+}
+
+const ReplacementPolicy *findReplacementPolicy(const char *name) {
+    for (int i = 0; replacementPolicies[i] != NULL; i++) {
+        if (strcmp(name, replacementPolicies[i]->name) == 0) {
+            return replacementPolicies[i];
+        }
     }
+    return NULL;
 }
 
-bool randomEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv){
+bool randomEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
 
     if (set->numberOfLines == 0) {
         perror("ERROR calling random!!!");
         return false;
     }
 
-    OutputInfo evictInfo;
-    evictInfo.address = info->address;
-    evictInfo.compResult = info->compResult;
-    evictInfo.ifEvict = info->ifEvict;
-    evictInfo.ifHit =info->ifHit;
-    evictInfo.roundedCompSize = info->roundedCompSize;
-    evictInfo.timestamp = info->timestamp;
+    OutputInfo evictInfo = *info;
 
     int evictIndex = 0;
-    srand(time(0) + rand());
-
-    char *outputInfo = NULL;
+    // Depends only on the set's own history, so a sharded run picks the same victims
+    uint64_t key = ctx->seed ^ ((uint64_t)info->address << 24) ^ set->clock;
 
     while (set->remainingSize < line->roundedCompSize)
     {
-        evictIndex = rand() % set->numberOfLines;
+        // Pick the n-th occupied slot
+        uint64_t used = usedSlots(set);
+        key += 0x9E3779B97F4A7C15ULL;
+        for(int n = drawRandom(key, set->numberOfLines); n > 0; n--){
+            used &= used - 1;
+        }
+        evictIndex = __builtin_ctzll(used);
         // printf("\nRANDOM: evict %d\n", evictIndex);
 
-        evictInfo.compResult = set->lines[evictIndex].compResult;
-        evictInfo.roundedCompSize = set->lines[evictIndex].roundedCompSize;
-        evictInfo.timestamp = set->lines[evictIndex].timestamp;
+        evictInfo.compResult = set->compResults[evictIndex];
+        evictInfo.roundedCompSize = set->sizes[evictIndex];
+        evictInfo.timestamp = lineAge(set, evictIndex);
 
-        outputInfo = generateOutputInfo(evictInfo);
-        fprintf(csv, "%s", outputInfo);
-        free(outputInfo);
-        outputInfo = NULL;
+        writeOutputInfo(&(ctx->out), &evictInfo);
 
-        removeLineFromCacheSet(set, set->lines[evictIndex].tag);
+        removeLineFromCacheSetBySlot(set, evictIndex);
     }
 
     return true;
 }
 
-bool bestfitEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv){
+bool bestfitEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
 
     if (set->numberOfLines == 0) {
         perror("ERROR calling random!!!");
         return false;
     }
 
-    OutputInfo evictInfo;
-    evictInfo.address = info->address;
-    evictInfo.compResult = info->compResult;
-    evictInfo.ifEvict = info->ifEvict;
-    evictInfo.ifHit =info->ifHit;
-    evictInfo.roundedCompSize = info->roundedCompSize;
-    evictInfo.timestamp = info->timestamp;
-
-    char *outputInfo = NULL;
+    OutputInfo evictInfo = *info;
 
-    unsigned int sizes[set->numberOfLines];
-    unsigned int goalSize = line->roundedCompSize - set->remainingSize;
+    // Sizes are counted in 4-byte quanta, the unit lines are rounded to
+    unsigned int quanta[MAX_LINES_PER_SET];
+    int slots[MAX_LINES_PER_SET];
+    unsigned int goal = (line->roundedCompSize - set->remainingSize) / 4;
 
-    for(int i = 0; i < set->numberOfLines; i++){
-        sizes[i] = set->lines[i].roundedCompSize;
+    int count = 0;
+    for(uint64_t used = usedSlots(set); used != 0; used &= used - 1){
+        int i = __builtin_ctzll(used);
+        slots[count] = i;
+        quanta[count++] = set->sizes[i] / 4;
     }
 
-    minDifference(sizes, set->numberOfLines, goalSize);
+    int victims[MAX_LINES_PER_SET];
+    int victimCount = selectBestfitVictims(quanta, count, goal, victims);
 
-    int *intArray = NULL;
-    int arrSize = 0;
-    doubleToIntegerArray(closest, &intArray, &arrSize);
+    for(int v = 0; v < victimCount; v++){
+        int slot = slots[victims[v]];
 
-    for(int i = 0; i < arrSize; i++){
+        evictInfo.compResult = set->compResults[slot];
+        evictInfo.roundedCompSize = set->sizes[slot];
+        evictInfo.timestamp = lineAge(set, slot);
 
-        removeLineFromCacheSetBySize(set, intArray[i], &evictInfo);
-        outputInfo = generateOutputInfo(evictInfo);
-        fprintf(csv, "%s", outputInfo);
-        free(outputInfo);
-        outputInfo = NULL;
+        removeLineFromCacheSetBySlot(set, slot);
+        writeOutputInfo(&(ctx->out), &evictInfo);
     }
 
-    diff = INT_MAX;
-    closest = 0;
-    free(intArray);
-    intArray = NULL;
-
-    // printf("\nBESTFIT remove total: %d lines\n", arrSize);
+    // printf("\nBESTFIT remove total: %d lines\n", victimCount);
 
     return true;
 }
 
-bool LRUEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv){
+bool LRUEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
 
     if (set->numberOfLines == 0) {
         perror("ERROR calling random!!!");
         return false;
     }
 
-    OutputInfo evictInfo;
-    evictInfo.address = info->address;
-    evictInfo.compResult = info->compResult;
-    evictInfo.ifEvict = info->ifEvict;
-    evictInfo.ifHit =info->ifHit;
-    evictInfo.roundedCompSize = info->roundedCompSize;
-    evictInfo.timestamp = info->timestamp;
-
-    char *outputInfo = NULL;
-
-    int count = set->numberOfLines;
-
-    unsigned long timeArr[count];
-
-    for(int i = 0; i < count; i++){
-        timeArr[i] = set->lines[i].timestamp;
-        // printf("\ntime: %ld\n", timeArr[i]);
-    }
-
-    bubbleSort(timeArr, count);
-    int index = 0;
+    OutputInfo evictInfo = *info;
 
     while (set->remainingSize < line->roundedCompSize)
     {
-        removeLineFromCacheSetByTime(set, timeArr[index], &evictInfo);
-        index++;
-
-        outputInfo = generateOutputInfo(evictInfo);
-        fprintf(csv, "%s", outputInfo);
-        free(outputInfo);
-        outputInfo = NULL;
-
-        if(index >= count){
+        if(set->numberOfLines == 0){
             perror("ERROR in LRU!!!");
             return false;
         }
+
+        // The least recently used line has the oldest access time
+        uint64_t used = usedSlots(set);
+        int victim = __builtin_ctzll(used);
+        for(used &= used - 1; used != 0; used &= used - 1){
+            int i = __builtin_ctzll(used);
+            if(set->lastAccess[i] < set->lastAccess[victim]){
+                victim = i;
+            }
+        }
+
+        evictInfo.compResult = set->compResults[victim];
+        evictInfo.roundedCompSize = set->sizes[victim];
+        evictInfo.timestamp = lineAge(set, victim);
+
+        removeLineFromCacheSetBySlot(set, victim);
+
+        writeOutputInfo(&(ctx->out), &evictInfo);
     }
 
     return true;
 }
 
-bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv){
+bool CAMPEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info){
     //printf("\nCAMPEvict\n");
     //printCacheLineInfo(line);
     if (set->numberOfLines == 0) {
@@ -614,15 +769,7 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
         return false;
     }
 
-    OutputInfo evictInfo;
-    evictInfo.address = info->address;
-    evictInfo.compResult = info->compResult;
-    evictInfo.ifEvict = info->ifEvict;
-    evictInfo.ifHit =info->ifHit;
-    evictInfo.roundedCompSize = info->roundedCompSize;
-    evictInfo.timestamp = info->timestamp;
-
-    char *outputInfo = NULL;
+    OutputInfo evictInfo = *info;
 
     while (set->remainingSize < line->roundedCompSize) {
         int victim_idx = -1;
@@ -635,14 +782,14 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
         }
         //Find the victim with highest MVE
         //printf("\nSearching set\n");
-        for(int i = 0; i < set->numberOfLines; i++){
+        for(uint64_t used = usedSlots(set); used != 0; used &= used - 1){
+            int i = __builtin_ctzll(used);
             //printf("\nidx: %d num_lines:%d\n", i, set->numberOfLines);
-            //printCacheLineInfo(&set->lines[i]);
-            int candidate_rrvp = set->lines[i].rrvp;
+            int candidate_rrvp = set->rrvp[i];
             //printf("\nc_rrvp: %d\n",candidate_rrvp);
-            int candidate_compression_idx = ((set->lines[i].roundedCompSize) / 4) -1;
+            int candidate_compression_idx = ((set->sizes[i]) / 4) -1;
             //printf("\nc_comp_idx: %d\n",candidate_compression_idx);
-            int candidate_compression = set->CAMP_weight_table[candidate_compression_idx];
+            int candidate_compression = ctx->cache->CAMP_weight_table[candidate_compression_idx];
             //printf("\nc_comp: %d\n", candidate_compression);
             int candidate_MVE = candidate_rrvp / candidate_compression;
             //printf("\nc_rrvp: %d, c_comp: %d, c_mve: %d\n",candidate_rrvp, candidate_compression, candidate_MVE);
@@ -661,19 +808,12 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
         }
 
         //Update evict info
-        evictInfo.compResult = set->lines[victim_idx].compResult;
-        evictInfo.roundedCompSize = set->lines[victim_idx].roundedCompSize;
-        evictInfo.timestamp = set->lines[victim_idx].timestamp;
+        evictInfo.compResult = set->compResults[victim_idx];
+        evictInfo.roundedCompSize = set->sizes[victim_idx];
+        evictInfo.timestamp = lineAge(set, victim_idx);
 
         //Reclaim the space
-        int size = set->lines[victim_idx].roundedCompSize;
-        set->remainingSize += size;
-
-        // Move the last line to the removed spot to keep array compact
-        if(victim_idx != set->numberOfLines - 1){
-            set->lines[victim_idx] = set->lines[set->numberOfLines - 1];
-        }
-        set->numberOfLines--;
+        removeLineFromCacheSetBySlot(set, victim_idx);
 
         //if highest_rrvp != rrvp_max, add the diff to every rrpv
         int diff = rrvp_max - highest_rrvp;
@@ -682,20 +822,18 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
             return false;
         }
         if(diff > 0){
-            for(int j = 0; j < set->numberOfLines; j++){
-                if(set->lines[j].rrvp + diff > rrvp_max){
-                    set->lines[j].rrvp = rrvp_max;
+            for(uint64_t used = usedSlots(set); used != 0; used &= used - 1){
+                int j = __builtin_ctzll(used);
+                if(set->rrvp[j] + diff > rrvp_max){
+                    set->rrvp[j] = rrvp_max;
                 } else {
-                    set->lines[j].rrvp += diff;
+                    set->rrvp[j] += diff;
                 }
             }
         }
-        updateCamp(set, line->roundedCompSize);
-        outputInfo = generateOutputInfo(evictInfo);
-        fprintf(csv, "%s", outputInfo);
-        free(outputInfo);
-        outputInfo = NULL;
-        //printf("\nRemoved cacheline idx: %d, size: %d, MVE: %d\n", victim_idx, size, victim_mve);
+        updateCamp(ctx, line->roundedCompSize);
+        writeOutputInfo(&(ctx->out), &evictInfo);
+        //printf("\nRemoved cacheline idx: %d, MVE: %d\n", victim_idx, victim_mve);
     }
     //printf("\nCAMPEvict exit\n");
     return true;
@@ -708,83 +846,359 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
  * =====================================================================================
  */
 
-char *generateOutputInfo(OutputInfo info) {
-    int size = 150;
-    char *output = malloc(size * sizeof(char));
-    if (output == NULL) {
-        perror("Failed to allocate memory");
+// Simulate count decoded records, shared by the serial, pipelined and sharded runs
+// and instantiated once per kernel below
+static inline __attribute__((always_inline)) void simulateTraceRecords(SimContext *ctx, const TraceRecord *records, unsigned long firstRecord, size_t count, unsigned int offsetBits, unsigned int indexBits, unsigned int linesPerSet) {
+    for (size_t i = 0; i < count; i++) {
+        const TraceRecord *record = &records[i];
+        unsigned int index = splitAddress(record->address, offsetBits, indexBits).index;
+        if (index < ctx->shardBegin || index >= ctx->shardEnd) {
+            continue;  // Another thread owns this set
+        }
+        ctx->stats.instructionCount++;
+        if(record->operation == 'l'){
+            ctx->stats.loadCount++;
+        }else if(record->operation == 's'){
+            ctx->stats.storeCount++;
+        }
+        cachingShaped(ctx, record->address, record->operation, firstRecord + i, offsetBits, indexBits, linesPerSet);
+    }
+}
+
+static void simulateAnyShape(SimContext *ctx, const TraceRecord *records, unsigned long firstRecord, size_t count) {
+    const CacheGeometry *geometry = &(ctx->cache->geometry);
+    simulateTraceRecords(ctx, records, firstRecord, count, geometry->offsetBits, geometry->indexBits, geometry->linesPerSet);
+}
+
+// Common shapes as (cache KB, line bytes, associativity), all powers of two
+#define SIM_KERNEL_SHAPES(X) \
+    X(16, 32, 2) X(32, 32, 2) X(64, 32, 2) X(128, 32, 2) \
+    X(32, 32, 4) X(32, 64, 2) X(64, 64, 2) X(64, 64, 4)
+
+// Every shift, mask and tag-compare loop bound folds to a constant in these
+#define DEFINE_SIM_KERNEL(sizeKB, lineSize, associativity) \
+    static void simulate_##sizeKB##_##lineSize##_##associativity(SimContext *ctx, const TraceRecord *records, unsigned long firstRecord, size_t count) { \
+        simulateTraceRecords(ctx, records, firstRecord, count, \
+                             __builtin_ctz(lineSize), \
+                             __builtin_ctz((sizeKB) * 1024 / ((lineSize) * (associativity))), \
+                             SLOTS_PER_SET((lineSize) * (associativity))); \
+    }
+
+SIM_KERNEL_SHAPES(DEFINE_SIM_KERNEL)
+
+#define SIM_KERNEL_ENTRY(sizeKB, lineSize, associativity) \
+    {sizeKB, lineSize, associativity, simulate_##sizeKB##_##lineSize##_##associativity},
+
+static const struct {
+    unsigned int cacheSizeKB;
+    unsigned int lineSize;
+    unsigned int associativity;
+    SimKernel kernel;
+} simKernels[] = {
+    SIM_KERNEL_SHAPES(SIM_KERNEL_ENTRY)
+};
+
+SimKernel selectSimKernel(const CacheGeometry *geometry) {
+    for (size_t i = 0; i < sizeof(simKernels) / sizeof(simKernels[0]); i++) {
+        if (simKernels[i].cacheSizeKB == geometry->cacheSizeKB &&
+            simKernels[i].lineSize == geometry->lineSize &&
+            simKernels[i].associativity == geometry->associativity) {
+            return simKernels[i].kernel;
+        }
+    }
+    return simulateAnyShape;
+}
+
+// Records that can be simulated from firstRecord on before the policy's tick is due
+static size_t simulationChunk(const SimContext *ctx, unsigned long firstRecord, size_t remaining) {
+    if (ctx->policy->tick != NULL) {
+        size_t untilTick = ctx->epoch - firstRecord % ctx->epoch;
+        return remaining < untilTick ? remaining : untilTick;
+    }
+    return remaining;
+}
+
+// True when the policy ticks right after record number nextRecord - 1
+static bool policyTickPoint(const SimContext *ctx, unsigned long nextRecord) {
+    return ctx->policy->tick != NULL && nextRecord % ctx->epoch == 0;
+}
+
+// Train the policy on the counters of the epoch that just ended, then start a new one
+static void tickPolicy(Cache *cache, unsigned long *counters) {
+    cache->policy->tick(cache, counters);
+    memset(counters, 0, POLICY_COUNTERS * sizeof(counters[0]));
+}
+
+// Run one decoded batch through every context, one at a time so that its cache's sets
+// stay in the CPU caches for the whole chunk
+static void simulateTraceBatch(SimContext *contexts, unsigned int contextCount, SimKernel *kernels, const TraceRecord *records, unsigned long firstRecord, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        size_t chunk = simulationChunk(&contexts[0], firstRecord + done, count - done);
+        for (unsigned int c = 0; c < contextCount; c++) {
+            kernels[c](&contexts[c], records + done, firstRecord + done, chunk);
+        }
+        done += chunk;
+        if (policyTickPoint(&contexts[0], firstRecord + done)) {
+            for (unsigned int c = 0; c < contextCount; c++) {
+                tickPolicy(contexts[c].cache, contexts[c].policyCounters);
+            }
+        }
+    }
+}
+
+typedef struct {
+    SimContext *contexts;          // Their caches are shared by every worker, each owns a slice of the sets
+    unsigned int contextCount;
+    unsigned int threadCount;
+    const TraceBuffer *trace;
+    struct ShardWorker *workers;   // threadCount workers, their policy counters are merged on a tick
+    pthread_barrier_t barrier;     // Policy ticks, see simulationChunk
+} ShardedRun;
+
+typedef struct ShardWorker {
+    ShardedRun *run;
+    unsigned int id;
+    SimContext views[MAX_CACHE_CONFIGS]; // The run's contexts with this worker's set range and counters
+    pthread_t thread;
+} ShardWorker;
+
+static void *shardWorkerThread(void *arg) {
+    ShardWorker *worker = arg;
+    ShardedRun *run = worker->run;
+    const SimContext *first = &(run->contexts[0]);
+    SimKernel kernels[MAX_CACHE_CONFIGS];
+
+    for (unsigned int c = 0; c < run->contextCount; c++) {
+        kernels[c] = selectSimKernel(&(worker->views[c].cache->geometry));
+    }
+
+    // Every worker walks the whole trace and simulates the records of its own sets
+    size_t done = 0;
+    while (done < run->trace->count) {
+        size_t chunk = simulationChunk(first, done, run->trace->count - done);
+        for (unsigned int c = 0; c < run->contextCount; c++) {
+            kernels[c](&(worker->views[c]), run->trace->records + done, done, chunk);
+        }
+        done += chunk;
+        if (policyTickPoint(first, done)) {
+            // Policy state is shared by every set, so all workers stop at the same record
+            pthread_barrier_wait(&run->barrier);
+            if (worker->id == 0) {
+                for (unsigned int c = 0; c < run->contextCount; c++) {
+                    unsigned long counters[POLICY_COUNTERS] = {0};
+                    for (unsigned int w = 0; w < run->threadCount; w++) {
+                        unsigned long *part = run->workers[w].views[c].policyCounters;
+                        for (int k = 0; k < POLICY_COUNTERS; k++) {
+                            counters[k] += part[k];
+                            part[k] = 0;
+                        }
+                    }
+                    tickPolicy(run->contexts[c].cache, counters);
+                }
+            }
+            pthread_barrier_wait(&run->barrier);
+        }
+    }
+    return NULL;
+}
+
+// Sets evolve independently between policy ticks, so each thread simulates a
+// contiguous range of every cache's sets and the counters are summed at the end
+static void simulateTraceBufferSharded(SimContext *contexts, unsigned int contextCount, const TraceBuffer *trace, unsigned int threads) {
+    ShardedRun run = {contexts, contextCount, threads, trace};
+    ShardWorker *workers = malloc(run.threadCount * sizeof(ShardWorker));
+    run.workers = workers;
+    if (workers == NULL || pthread_barrier_init(&run.barrier, NULL, run.threadCount) != 0) {
+        perror("Failed to start worker threads");
         exit(EXIT_FAILURE);
     }
 
-    // Format the output string
-    snprintf(output, size, "%lx,%d,%d,%u,%lu,%u,%u,%u,%u,%u\n",
-             info.address,
-             info.ifHit,
-             info.ifEvict,
-             info.roundedCompSize,
-             info.timestamp,
-             info.compResult.isZero,
-             info.compResult.isSame,
-             info.compResult.compSize,
-             info.compResult.K,
-             info.compResult.BaseNum);
+    for (unsigned int w = 0; w < run.threadCount; w++) {
+        workers[w].run = &run;
+        workers[w].id = w;
+        for (unsigned int c = 0; c < contextCount; c++) {
+            SimContext *view = &(workers[w].views[c]);
+            unsigned long sets = contexts[c].cache->geometry.numberOfSets;
+            initializeSimContext(view, contexts[c].cache, contexts[c].seed, contexts[c].compResult, contexts[c].compResultCount);
+            view->epoch = contexts[c].epoch;
+            view->shardBegin = sets * w / run.threadCount;
+            view->shardEnd = sets * (w + 1) / run.threadCount;
+            openOutputWriter(&(view->out), NULL, OUTPUT_SUMMARY, view->policy->name, &(view->stats.summary));
+        }
+        if (pthread_create(&workers[w].thread, NULL, shardWorkerThread, &workers[w]) != 0) {
+            perror("Failed to start worker threads");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (unsigned int w = 0; w < run.threadCount; w++) {
+        pthread_join(workers[w].thread, NULL);
+        for (unsigned int c = 0; c < contextCount; c++) {
+            closeOutputWriter(&(workers[w].views[c].out));
+            mergeSimStats(&(contexts[c].stats), &(workers[w].views[c].stats));
+        }
+    }
+
+    pthread_barrier_destroy(&run.barrier);
+    free(workers);
+}
+
+// Hand the whole trace to offline policies, once per policy with all of its caches
+static void prepareCaches(SimContext *contexts, unsigned int contextCount, const TraceBuffer *trace) {
+    Cache *caches[MAX_CACHE_CONFIGS];
+    for (unsigned int c = 0; c < contextCount; c++) {
+        const ReplacementPolicy *policy = contexts[c].policy;
+        bool prepared = false;
+        for (unsigned int p = 0; p < c; p++) {
+            prepared |= contexts[p].policy == policy;
+        }
+        if (policy->prepare == NULL || prepared) {
+            continue;
+        }
+        unsigned int cacheCount = 0;
+        for (unsigned int i = c; i < contextCount; i++) {
+            if (contexts[i].policy == policy) {
+                caches[cacheCount++] = contexts[i].cache;
+            }
+        }
+        policy->prepare(caches, cacheCount, trace);
+    }
+}
 
-    return output;
+void simulateTraceBuffer(SimContext *contexts, unsigned int contextCount, const TraceBuffer *trace, unsigned int threads) {
+    prepareCaches(contexts, contextCount, trace);
+    if (threads > 1) {
+        simulateTraceBufferSharded(contexts, contextCount, trace, threads);
+    } else {
+        SimKernel kernels[MAX_CACHE_CONFIGS];
+        for (unsigned int c = 0; c < contextCount; c++) {
+            kernels[c] = selectSimKernel(&(contexts[c].cache->geometry));
+            openOutputWriter(&(contexts[c].out), NULL, OUTPUT_SUMMARY, contexts[c].policy->name, &(contexts[c].stats.summary));
+        }
+        simulateTraceBatch(contexts, contextCount, kernels, trace->records, 0, trace->count);
+        for (unsigned int c = 0; c < contextCount; c++) {
+            closeOutputWriter(&(contexts[c].out));
+        }
+    }
+    for (unsigned int c = 0; c < contextCount; c++) {
+        contexts[c].stats.instructionCount += trace->malformed;
+    }
 }
 
-void processTraceFile(Cache *cache, const char *filename, CompressionResult *compResult) {
-    FILE *file = fopen(filename, "r");
-    if (file == NULL) {
+void processTraceFile(SimContext *contexts, unsigned int contextCount, const char *filename, const SimOptions *options) {
+    if (options->threads > 1) {
+        TraceBuffer trace;
+        if (loadTraceBuffer(&trace, filename) != 0) {
+            perror("Failed to open file");
+            exit(EXIT_FAILURE);
+        }
+        simulateTraceBuffer(contexts, contextCount, &trace, options->threads);
+        freeTraceBuffer(&trace);
+        return;
+    }
+
+    // Offline policies need the whole trace before the first access
+    bool buffered = contexts[0].policy->prepare != NULL;
+    TraceBuffer trace;
+    TraceReader reader;
+    TracePipeline pipeline;
+
+    if (buffered) {
+        if (loadTraceBuffer(&trace, filename) != 0) {
+            perror("Failed to open file");
+            exit(EXIT_FAILURE);
+        }
+        prepareCaches(contexts, contextCount, &trace);
+    } else if (options->pipelined) {
+        if (startTracePipeline(&pipeline, filename) != 0) {
+            perror("Failed to open file");
+            exit(EXIT_FAILURE);
+        }
+    } else if (openTraceReader(&reader, filename) != 0) {
         perror("Failed to open file");
         exit(EXIT_FAILURE);
     }
 
-    char *csvName = processTraceFileName(filename);
-
-    FILE *csv = fopen(csvName, "w");
-    if (csv == NULL) {
-        perror("Unable to open file");
+    SimKernel *kernels = malloc(contextCount * sizeof(SimKernel));
+    if (kernels == NULL) {
+        perror("Memory allocation failed");
         exit(EXIT_FAILURE);
     }
-    free(csvName);
-
-    fprintf(csv, "MemAddress,ifHit,ifEvict,roundedCompSize,timestamp,isZero,isSame,compSize,K,baseNum\n");
-
-    char line[1024];
-    char operation;  // 'l' for load, 's' for store
-    unsigned long address;
-
-    while (fgets(line, sizeof(line), file) != NULL) {
-        instructionCount++;
-        // if(instructionCount % 10000 == 0){
-        //     int n = instructionCount / 10000;
-        //     printf("\nProcessed %d x 10k...\n", n);
-        // }
-        if (sscanf(line, "%c 0x%lx", &operation, &address) == 2) {
-            if(operation == 'l'){
-                loadCount++;
-            }else if(operation == 's'){
-                storeCount++;
+
+    for (unsigned int c = 0; c < contextCount; c++) {
+        const CacheGeometry *geometry = &(contexts[c].cache->geometry);
+        const char *policyName = contexts[c].policy->name;
+        const char *extension = options->outputFormat == OUTPUT_COLUMNAR ? COLUMNAR_SUFFIX : ".csv";
+        char sizedExtension[64];
+        if (contextCount > 1) {
+            // One output file per geometry: <trace>_<policy>_<size>k_<line>b_<ways>w.csv
+            snprintf(sizedExtension, sizeof(sizedExtension), "_%uk_%ub_%uw%s", geometry->cacheSizeKB, geometry->lineSize, geometry->associativity, extension);
+            extension = sizedExtension;
+        }
+        char *outputName = options->outputFormat == OUTPUT_SUMMARY ? NULL : processTraceFileName(filename, policyName, extension);
+
+        if (openOutputWriter(&(contexts[c].out), outputName, options->outputFormat, policyName, &(contexts[c].stats.summary)) != 0) {
+            perror("Unable to open file");
+            exit(EXIT_FAILURE);
+        }
+        free(outputName);
+        kernels[c] = selectSimKernel(geometry);
+    }
+
+    unsigned long nextRecord = 0;  // Trace index of the next decoded record
+    if (buffered) {
+        for (unsigned int c = 0; c < contextCount; c++) {
+            contexts[c].stats.instructionCount += trace.malformed;
+        }
+        simulateTraceBatch(contexts, contextCount, kernels, trace.records, 0, trace.count);
+        freeTraceBuffer(&trace);
+    } else if (options->pipelined) {
+        // The reader thread decodes batches while this thread simulates them
+        TraceBatch *batch;
+        while ((batch = acquireTraceBatch(&pipeline)) != NULL) {
+            for (unsigned int c = 0; c < contextCount; c++) {
+                contexts[c].stats.instructionCount += batch->malformed;
             }
-            cachingByAddrAndRandomMemContent(cache, compResult, address, operation, csv);
-            if(RP == CAMP){
-                if(cache->CAMP_training_counter == 1){
-                    CAMPWeightUpdate(cache);
-                    cache->CAMP_training_counter = 160;
-                } else {
-                    cache->CAMP_training_counter -= 1;
+            simulateTraceBatch(contexts, contextCount, kernels, batch->records, nextRecord, batch->count);
+            nextRecord += batch->count;
+            releaseTraceBatch(&pipeline);
+        }
+        stopTracePipeline(&pipeline);
+    } else {
+        // Decoded into a local batch so both paths run the same kernels
+        TraceRecord records[TRACE_BATCH_SIZE];
+        unsigned int count = 0;
+        TraceStatus status;
+        while ((status = nextTraceRecord(&reader, &records[count])) != TRACE_END) {
+            // if(instructionCount % 10000 == 0){
+            //     int n = instructionCount / 10000;
+            //     printf("\nProcessed %d x 10k...\n", n);
+            // }
+            if (status == TRACE_MALFORMED) {
+                // already reported by the reader
+                for (unsigned int c = 0; c < contextCount; c++) {
+                    contexts[c].stats.instructionCount++;
                 }
+                continue;
+            }
+            if (++count == TRACE_BATCH_SIZE) {
+                simulateTraceBatch(contexts, contextCount, kernels, records, nextRecord, count);
+                nextRecord += count;
+                count = 0;
             }
-        } else {
-            fprintf(stderr, "Error parsing line: %s", line);
         }
+        simulateTraceBatch(contexts, contextCount, kernels, records, nextRecord, count);
+        closeTraceReader(&reader);
     }
 
-    fclose(file);
-    fclose(csv);
+    for (unsigned int c = 0; c < contextCount; c++) {
+        closeOutputWriter(&(contexts[c].out));
+    }
+    free(kernels);
 }
 
-char *processTraceFileName(const char *filename) {
+char *processTraceFileName(const char *filename, const char *policyName, const char *extension) {
     const char *prefix = "testTraces/";
     const char *suffix = ".trace";
     const char *outputDir = "testOutput/";
@@ -796,7 +1210,10 @@ char *processTraceFileName(const char *filename) {
         start = filename;
     }
 
-    const char *end = strstr(start, suffix);
+    const char *end = strstr(start, BINARY_TRACE_SUFFIX);
+    if (end == NULL) {
+        end = strstr(start, suffix);
+    }
     if (end == NULL) {
         end = start + strlen(start);
     }
@@ -811,32 +1228,18 @@ char *processTraceFileName(const char *filename) {
     strncpy(name, start, nameLength);
     name[nameLength] = '\0';
 
-    char *newFilename = malloc(strlen(outputDir) + strlen(name) + 10 + 5);
+    char *newFilename = malloc(strlen(outputDir) + strlen(name) + strlen(policyName) + strlen(extension) + 2);
     if (newFilename == NULL) {
         perror("Failed to allocate memory for new filename");
         free(name);
         exit(EXIT_FAILURE);
     }
-    char *RPsuffix = "_lru";
-    switch (RP)
-    {
-    case RANDOM:
-        RPsuffix = "_random";
-        break;
-    case BESTFIT:
-        RPsuffix = "_bestfit";
-        break;
-    case LRU:
-        RPsuffix = "_lru";
-        break;
-    case CAMP:
-        RPsuffix = "_camp";
-        break;
-    default:
-        RPsuffix = "_lru";
-        break;
-    }
-    sprintf(newFilename, "%s%s%s.csv", outputDir, name, RPsuffix);
+    // "<outputDir><name>_<policy><extension>"
+    char *p = stpcpy(newFilename, outputDir);
+    p = stpcpy(p, name);
+    *p++ = '_';
+    p = stpcpy(p, policyName);
+    stpcpy(p, extension);
 
     free(name);
     return newFilename;
@@ -852,45 +1255,20 @@ int cmp(const void *a, const void *b)
     else if ((*a1).value < (*a2).value)
         return 1;
     else
-        return 0;
+        return (*a1).index - (*a2).index;  // Ties keep class order whatever qsort does
 }
 
-void CAMPWeightUpdate(Cache* cache){
-    //printf("Entered Weight Update\n");
-    arrayTuple result_array[8];
-    for(int i = 0; i < 8; i++){
-        result_array[i].value = 0;
+void CAMPWeightUpdate(Cache* cache, const unsigned long *history){
+    // Lines are never larger than the line size, so only that many classes are ranked
+    int classes = cache->geometry.lineSize / 4;
+    arrayTuple result_array[CAMP_SIZE_CLASSES];
+    for(int i = 0; i < classes; i++){
+        result_array[i].value = history[i] > INT_MAX ? INT_MAX : (int)history[i];
         result_array[i].index = i;
     }
-    //printf("initialized result_array\n");
-    for(int j=0; j < NUMBER_OF_SETS; j++){
-        for(int k = 0; k < 16; k++){
-            CacheSet tmpSet;
-            tmpSet = cache->sets[j];
-            int history = tmpSet.CAMP_history_buffer[k] / 4;
-            if(history > 0){
-                //printf("j: %d, k:%d, history: %d\n", j, k, history);
-                result_array[history-1].value += 1;
-            }
-            //printf("result_array new value: %d\n", result_array[history].value);
-            cache->sets[j].CAMP_history_buffer[k] = 0;
-            if(cache->sets[j].CAMP_history_buffer[k] != 0) printf("%d\n",cache->sets[j].CAMP_history_buffer[k]);
-        }
-        cache->sets[j].CAMP_hb_count = 0;
-    }
-    //printf("updated result_array\n");
-    qsort(result_array, 8, sizeof(result_array[0]), cmp);
-    //printf("sorted result_array\n");
-    int NewWeightTable[8];
-    for(int i = 0; i < 8; i++){
-        NewWeightTable[result_array[7-i].index] = i + 1;
+    qsort(result_array, classes, sizeof(result_array[0]), cmp);
+    // The most frequent size class gets the largest weight
+    for(int i = 0; i < classes; i++){
+        cache->CAMP_weight_table[result_array[classes-1-i].index] = i + 1;
     }
-    //printf("new weight table formed\n");
-    for(int j = 0; j < NUMBER_OF_SETS; j++){
-        for(int k = 0; k < 8; k++){
-            cache->sets[j].CAMP_weight_table[k] = NewWeightTable[k];
-        }
-    }
-    //printf("copied new weight table over\n");
-    return;
-}
\ No newline at end of file
+}
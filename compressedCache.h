@@ -2,7 +2,7 @@
  * compressedCache.h
  * 
  * Created by Penggao Li
- * Last modified: 04/29/2024
+ * Last modified: 10/17/2026
  */
 
 #include <stdio.h>
@@ -15,8 +15,14 @@
 #include <time.h>
 #include <string.h>
 #include <unistd.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #include "bdi.h"
+#include "compressors.h"
+#include "traceReader.h"
+#include "tracePipeline.h"
 
 /* =====================================================================================
  * 
@@ -25,13 +31,46 @@
  * =====================================================================================
  */
 
-#define CACHE_SIZE_KB 32
-#define LINE_SIZE 32
-#define SET_ASSOCIATIVITY 2
-#define NUMBER_OF_SETS (CACHE_SIZE_KB * 1024 / (LINE_SIZE * SET_ASSOCIATIVITY))
+// Geometry used when none is given on the command line
+#define DEFAULT_CACHE_SIZE_KB 32
+#define DEFAULT_LINE_SIZE 32
+#define DEFAULT_SET_ASSOCIATIVITY 2
+
+#define MAX_LINE_SIZE 128
+#define MAX_LINES_PER_SET 64       // Slot masks are 64 bits wide, so a set holds at most 256 bytes
+// Every line takes at least 4 bytes of a set, slots are padded to whole 8-tag vector groups
+#define SLOTS_PER_SET(setSize) ((((setSize) / 4) + 7) & ~7u)
+
+#define MAX_CACHE_CONFIGS 64        // Geometries simulated in one trace pass or sweep
+#define MAX_REPLACEMENT_POLICIES 16 // Policies in one sweep
+
+#define CAMP_SIZE_CLASSES (MAX_LINE_SIZE / 4)  // One weight per roundedCompSize / 4 - 1
+#define POLICY_EPOCH 160            // Default records between two ticks of a policy, e.g. CAMPWeightUpdate
+#define POLICY_COUNTERS 64          // Per-context counters a policy can train on
+#define DUEL_PERIOD 64              // Set-dueling leader sets repeat every DUEL_PERIOD sets
 
 #define rrvp_max 8
 
+#define SUMMARY_SIZE_BUCKETS (MAX_LINE_SIZE / 4 + 1)                    // One per roundedCompSize / 4
+#define SUMMARY_VICTIM_BUCKETS (MAX_LINES_PER_SET + 1)                  // Most lines one miss can evict
+#define SUMMARY_AGE_BUCKETS 33                                           // 0, then power-of-two ranges
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define OUTPUT_RECORD_MAX 256      // Upper bound for one formatted output record
+
+// Columnar result layout (all integers little-endian):
+//   header: "BDICOLS" NUL | u32 version | u32 rows per block | u32 column count
+//           | char[16] replacement policy | u64 row count
+//           | per column: char[24] name, u32 width in bytes
+//   block:  u32 rows in block | u32 zero, then each column as rows * width bytes
+// Every block but the last holds exactly "rows per block" rows, so a reader can
+// compute the offset of any column slice without scanning the file
+#define COLUMNAR_MAGIC "BDICOLS"
+#define COLUMNAR_VERSION 2
+#define COLUMNAR_BLOCK_ROWS 65536
+#define COLUMNAR_COLUMNS 11
+#define COLUMNAR_SUFFIX ".bcol"
+
 
 /* =====================================================================================
  * 
@@ -42,6 +81,8 @@
 
 typedef uint32_t addr_32_bit;
 
+typedef struct ReplacementPolicy ReplacementPolicy;  // See "Cache replacement functions"
+
 typedef struct {
     addr_32_bit tag;               // The tag for the compressed line
     unsigned int valid : 1;        // Valid bit
@@ -52,18 +93,77 @@ typedef struct {
     unsigned int rrvp;            // Value used for RRIP 
 } CompressedCacheLine;
 
+///
+/// Shape of a simulated cache, fixed when the cache is initialized. Addresses are split
+/// as | tag | index (indexBits) | offset (offsetBits) |
+///
 typedef struct {
-    CompressedCacheLine *lines;    // Dynamically allocated array of compressed lines
+    unsigned int cacheSizeKB;
+    unsigned int lineSize;         // Bytes, power of two
+    unsigned int associativity;
+    unsigned int numberOfSets;     // Power of two
+    unsigned int setSize;          // lineSize * associativity bytes
+    unsigned int linesPerSet;      // Slots per set, SLOTS_PER_SET(setSize)
+    unsigned int offsetBits;
+    unsigned int indexBits;
+} CacheGeometry;
+
+// Lines are stored field by field so that a lookup is one vector compare over tags[].
+// The per-set arrays hold linesPerSet entries each and are carved from the cache's pools.
+// Slot i is valid while bit i of validMask is set
+typedef struct {
+    addr_32_bit *tags;             // 32-byte aligned
+    uint64_t validMask;
+    unsigned long *lastAccess;     // Value of clock at the line's last access
+    unsigned long clock;           // Lookups of this set so far, only ever increases
+    unsigned char *rrvp;
+    unsigned short *sizes;         // roundedCompSize of each line
+    CompressionResult *compResults;
     unsigned int numberOfLines;    // Number of compressed lines in this set
-    unsigned int remainingSize;    // Remaining size in bytes in this set (64 bytes/set)
-    unsigned int CAMP_weight_table[8]; //one slot for every compression ratio (4byte = 0, 8byte = 1, etc)
-    unsigned int CAMP_history_buffer[16];
-    unsigned int CAMP_hb_count;
+    unsigned int remainingSize;    // Remaining size in bytes in this set
 } CacheSet;
 
+///
+/// Aggregate statistics collected from every output record, printed by printSimResult
+///
+typedef struct {
+    unsigned long evictions;
+    unsigned long insertedSize[SUMMARY_SIZE_BUCKETS];    // Lines inserted on a miss, by roundedCompSize / 4
+    unsigned long evictedSize[SUMMARY_SIZE_BUCKETS];     // Victims, by roundedCompSize / 4
+    unsigned long victimsPerMiss[SUMMARY_VICTIM_BUCKETS];
+    unsigned long victimAge[SUMMARY_AGE_BUCKETS];        // Victim timestamp: 0, 1, 2-3, 4-7, ...
+    unsigned long insertedBy[COMPRESSORS];               // Lines inserted on a miss, by compResult.algorithm
+    unsigned long evictedBy[COMPRESSORS];
+    unsigned long hitsBy[COMPRESSORS];                   // Hits, by the algorithm of the line hit
+    unsigned long storedInsertedBy[COMPRESSORS];         // Of the counts above, lines kept uncompressed
+    unsigned long storedEvictedBy[COMPRESSORS];
+    unsigned long storedHitsBy[COMPRESSORS];
+    unsigned int pendingVictims;   // Evictions seen since the last miss record
+} SimSummary;
+
+///
+/// Counters of one simulated cache, printed by printSimResult
+///
+typedef struct {
+    long instructionCount;         // Trace records, including malformed ones
+    long loadCount;
+    long loadHitCount;
+    long storeCount;
+    long storeHitCount;
+    SimSummary summary;
+} SimStats;
+
 typedef struct {
-    CacheSet sets[NUMBER_OF_SETS];
-    unsigned int CAMP_training_counter;
+    CacheGeometry geometry;
+    CacheSet *sets;                // geometry.numberOfSets sets
+    addr_32_bit *tagPool;          // Backing storage of the per-set slot arrays
+    unsigned long *lastAccessPool;
+    unsigned char *rrvpPool;
+    unsigned short *sizePool;
+    CompressionResult *compResultPool;
+    unsigned int CAMP_weight_table[CAMP_SIZE_CLASSES]; //one slot for every compression ratio (4byte = 0, 8byte = 1, etc), shared by all sets
+    const ReplacementPolicy *policy;
+    void *policyState;             // Policy-wide metadata from policy->createState, may be NULL
 } Cache;
 
 
@@ -74,13 +174,6 @@ typedef struct {
  * =====================================================================================
  */
 
-typedef enum {
-    RANDOM,
-    BESTFIT,
-    LRU,
-    CAMP
-}ReplacementPolicy;
-
 typedef struct {
     addr_32_bit tag;
     unsigned int index;
@@ -89,6 +182,7 @@ typedef struct {
 
 typedef struct {
     unsigned long address;
+    char operation;                // 'l' or 's' of the access that produced this record
     int ifHit;
     int ifEvict;
     unsigned int roundedCompSize;
@@ -96,28 +190,106 @@ typedef struct {
     CompressionResult compResult;
 }OutputInfo;
 
+typedef enum {
+    OUTPUT_CSV,                    // One text row per access / eviction
+    OUTPUT_COLUMNAR,               // Fixed-width binary columns, see COLUMNAR_MAGIC
+    OUTPUT_SUMMARY                 // No per-access file, only the aggregate report
+} OutputFormat;
+
+typedef struct {
+    OutputFormat format;
+    SimSummary *summary;           // Updated with every record, whatever the format
+    FILE *file;
+    char *buffer;                  // Records are formatted here and written in large blocks
+    size_t used;
+    unsigned char *columns[COLUMNAR_COLUMNS]; // Columnar only: one slice per column
+    unsigned int rows;             // Columnar only: rows in the current block
+    unsigned long long totalRows;  // Columnar only: rows written so far
+} OutputWriter;
+
 typedef struct {
     int value;
     int index;
 } arrayTuple;
 
-/* =====================================================================================
- * 
- *                           Global variables
- *  
- * =====================================================================================
- */
-
-extern ReplacementPolicy RP;
-
-extern int diff;
-extern double closest;
+///
+/// Everything one simulation reads or writes besides its cache: the policy, the seed
+/// every random choice is derived from, the pool of line contents, the counters and the
+/// output. Contexts share nothing, so any number of them can run side by side
+///
+typedef struct {
+    Cache *cache;
+    const ReplacementPolicy *policy; // cache->policy
+    unsigned long seed;            // Same seed, same trace: same output, see --seed
+    CompressionResult *compResult; // Line contents drawn on a miss
+    unsigned int compResultCount;
+    SimStats stats;
+    OutputWriter out;
+    unsigned int shardBegin;       // Only records that map to sets [shardBegin, shardEnd)
+    unsigned int shardEnd;         // are simulated, see SimOptions.threads
+    unsigned int epoch;            // Records between two ticks of the policy
+    unsigned long record;          // Trace index of the access being simulated
+    unsigned long policyCounters[POLICY_COUNTERS]; // Kept by the policy's hooks, reset on every tick
+} SimContext;
+
+///
+/// A replacement policy, registered by name in replacementPolicies. Hooks left NULL are
+/// skipped. The sets of one cache can be simulated by several threads, each owning a
+/// range of sets, so between ticks the hooks may write only the entries of
+/// cache->policyState that belong to the set they are given (e.g. opt's per-slot next
+/// uses). Anything shared by all sets goes through ctx->policyCounters, which are summed
+/// over every thread and handed to tick
+///
+struct ReplacementPolicy {
+    const char *name;
+    /// Free enough space in set for line, writing one output record per victim. When
+    /// NULL, the slot returned by victim is evicted until the line fits
+    bool (*evict)(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+    int (*victim)(SimContext *ctx, CacheSet *set, const CompressedCacheLine *line);
+    void (*insert)(SimContext *ctx, CacheSet *set, int slot);  // A missed line was placed in slot
+    void (*hit)(SimContext *ctx, CacheSet *set, int slot);
+    void *(*createState)(const CacheGeometry *geometry);       // Heap block, freed by freeCache
+    void (*tick)(Cache *cache, const unsigned long *counters); // Every SimContext.epoch records
+    void (*report)(const Cache *cache);                        // Extra lines for printSimResult
+    /// Offline policies only: called once with every cache using the policy and the whole
+    /// decoded trace before it is simulated, so that what depends only on the trace can be
+    /// built once and shared. Makes processTraceFile buffer the trace instead of streaming it
+    void (*prepare)(Cache *const *caches, unsigned int cacheCount, const TraceBuffer *trace);
+    void (*freeState)(void *state);                            // NULL: free()
+};
 
-extern long instructionCount;
-extern long loadCount;
-extern long loadHitCount;
-extern long storeCount;
-extern long storeHitCount;
+typedef struct {
+    bool pipelined;                // Decode the trace on a separate reader thread
+    OutputFormat outputFormat;
+    unsigned int threads;          // > 1 splits the sets of every cache across this many threads
+} SimOptions;
+
+///
+/// Simulate count decoded records against ctx's cache, records[0] being record number
+/// firstRecord of the trace. One kernel is compiled per common geometry, see
+/// selectSimKernel. The policy does not tick here, the caller does it every
+/// ctx->epoch records
+///
+typedef void (*SimKernel)(SimContext *ctx, const TraceRecord *records, unsigned long firstRecord, size_t count);
+
+// Occupied slots of a set, iterate with __builtin_ctzll and clear the lowest bit
+static inline uint64_t usedSlots(const CacheSet *set) {
+    return set->validMask;
+}
+
+// Lookups of the set since the line in slot was last accessed (the "timestamp" output)
+static inline unsigned long lineAge(const CacheSet *set, int slot) {
+    return set->clock - set->lastAccess[slot];
+}
+
+static inline unsigned int setIndex(const Cache *cache, const CacheSet *set) {
+    return set - cache->sets;
+}
+
+// Sets per round of leader sets, DUEL_PERIOD unless the cache has fewer sets
+static inline unsigned int duelPeriod(const CacheGeometry *geometry) {
+    return geometry->numberOfSets < DUEL_PERIOD ? geometry->numberOfSets : DUEL_PERIOD;
+}
 
 /* =====================================================================================
  * 
@@ -128,14 +300,27 @@ extern long storeHitCount;
 
 void initializeCacheLine(CompressedCacheLine *line, addr_32_bit tag, CompressionResult compResult);
 
-void initializeCacheSet(CacheSet *set);
+///
+/// Derive set count, masks and shifts from a cache size, line size and associativity.
+/// Returns 0 on success, -1 (with a message on stderr) if the shape is not supported
+///
+int initializeCacheGeometry(CacheGeometry *geometry, unsigned int cacheSizeKB, unsigned int lineSize, unsigned int associativity);
+
+void initializeCacheSet(CacheSet *set, const CacheGeometry *geometry);
 
 void freeCacheSet(CacheSet *set);
 
-void initializeCache(Cache *cache);
+void initializeCache(Cache *cache, const CacheGeometry *geometry, const ReplacementPolicy *policy);
 
 void freeCache(Cache *cache);
 
+///
+/// Point ctx at cache and its policy with zeroed counters, simulating every set. The
+/// output writer is opened separately. compResult must hold compResultCount entries
+/// and outlive ctx
+///
+void initializeSimContext(SimContext *ctx, Cache *cache, unsigned long seed, CompressionResult *compResult, unsigned int compResultCount);
+
 
 /* =====================================================================================
  * 
@@ -144,23 +329,46 @@ void freeCache(Cache *cache);
  * =====================================================================================
  */
 
+///
+/// Place line in a free slot of set. Returns the slot, or -1 if the set lacks the space
+///
 int addLineToCacheSet(CacheSet *set, CompressedCacheLine *line);
 
-bool addLineToCacheSetWithRP(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv);
+bool addLineToCacheSetWithRP(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
 
 void removeLineFromCacheSet(CacheSet *set, addr_32_bit tag);
 
+void removeLineFromCacheSetBySlot(CacheSet *set, int slot);
+
 void removeLineFromCacheSetBySize(CacheSet *set, unsigned int size, OutputInfo *evictInfo);
 
-void removeLineFromCacheSetByTime(CacheSet *set, unsigned long timestamp, OutputInfo *evictInfo);
+///
+/// Remove the line in slot and write it to ctx's output as a victim of evictInfo's access
+///
+void evictLineFromCacheSet(SimContext *ctx, CacheSet *set, int slot, OutputInfo *evictInfo);
+
+///
+/// Evict lines of set chosen by policy until line fits, see ReplacementPolicy.evict
+///
+void makeRoomInCacheSet(const ReplacementPolicy *policy, SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+
 
-bool ifHit(Cache *cache, addr_32_bit addr, OutputInfo *info);
+bool ifHit(SimContext *ctx, addr_32_bit addr, OutputInfo *info);
 
-void cachingByAddrAndRandomMemContent(Cache *cache, CompressionResult *compResultArr, addr_32_bit addr, char operation, FILE *csv);
+///
+/// Access addr as record number recordIndex of the trace. On a miss the line contents
+/// are drawn from ctx->compResult as a function of ctx->seed and recordIndex only, so
+/// every cache, and every shard of a cache, sees the same contents for the same record
+///
+void cachingByAddrAndRandomMemContent(SimContext *ctx, addr_32_bit addr, char operation, unsigned long recordIndex);
 
-void updateCamp(CacheSet *set, int size);
+void updateCamp(SimContext *ctx, int size);
 
-void CAMPWeightUpdate(Cache* cache);
+///
+/// Rank the size classes by how often they were accessed in history and give every
+/// set of cache the new weights
+///
+void CAMPWeightUpdate(Cache* cache, const unsigned long *history);
 
 /* =====================================================================================
  * 
@@ -169,23 +377,30 @@ void CAMPWeightUpdate(Cache* cache);
  * =====================================================================================
  */
 
-AddressParts extractAddressParts(addr_32_bit address);
+AddressParts extractAddressParts(const CacheGeometry *geometry, addr_32_bit address);
 
-void dfs(unsigned int* nums, int size, int goal, int start, int sum, double evictedIndex);
-
-void minDifference(unsigned int* nums, int size, int goal);
-
-void doubleToIntegerArray(double value, int **array, int *size);
-
-void bubbleSort(unsigned long arr[], int n);
+///
+/// BESTFIT victims: the subset of quanta[0..count) with the smallest sum >= goal, found
+/// with a subset-sum bitset in O(count). Among equal sums the lowest indices are taken.
+/// Writes the chosen indices to victims in increasing order and returns how many, 0 if
+/// no subset reaches goal. The quanta must sum to at most 64
+///
+int selectBestfitVictims(const unsigned int *quanta, int count, unsigned int goal, int *victims);
 
 int cmp(const void *a, const void *b);
 
-int generateRandom(int range);
+///
+/// Counter-based generator: a uniform value in [0, range) that depends only on key.
+/// Callers mix the context's seed with the record or set being simulated, so draws do
+/// not depend on the order in which records, caches or shards are simulated
+///
+int drawRandom(uint64_t key, int range);
 
 void printCacheLineInfo(CompressedCacheLine *line);
 
-void printSimResult(const char *filename);
+void printSimResult(const SimContext *ctx, const char *filename);
+
+void printMissRatioCurve(const SimContext *contexts, unsigned int contextCount);
 
 
 /* =====================================================================================
@@ -195,15 +410,62 @@ void printSimResult(const char *filename);
  * =====================================================================================
  */
 
-ReplacementPolicy chooseReplacementPolicy();
+extern const ReplacementPolicy *const replacementPolicies[]; // NULL-terminated, in menu order
 
-bool randomEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv);
+extern const ReplacementPolicy randomPolicy;
+extern const ReplacementPolicy bestfitPolicy;
+extern const ReplacementPolicy lruPolicy;
+extern const ReplacementPolicy campPolicy;
 
-bool bestfitEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv);
+const ReplacementPolicy *chooseReplacementPolicy();
 
-bool LRUEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv);
+///
+/// The registered policy called name, NULL if there is none
+///
+const ReplacementPolicy *findReplacementPolicy(const char *name);
 
-bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE *csv);
+bool randomEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+
+bool bestfitEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+
+bool LRUEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+
+bool CAMPEvict(SimContext *ctx, CacheSet *set, CompressedCacheLine *line, OutputInfo *info);
+
+
+/* =====================================================================================
+ * 
+ *                           RRIP-based policies
+ *  
+ * =====================================================================================
+ */
+
+// Re-reference interval prediction over the rrvp slots of each set (rripPolicies.c)
+extern const ReplacementPolicy srripPolicy;   // Static RRIP, hit priority
+extern const ReplacementPolicy drripPolicy;   // Set dueling between SRRIP and bimodal RRIP
+extern const ReplacementPolicy sipPolicy;     // SRRIP, size classes that earn it inserted near
+extern const ReplacementPolicy ecmPolicy;     // Large lines inserted distant, largest evicted first
+
+
+/* =====================================================================================
+ * 
+ *                           Adaptive policy
+ *  
+ * =====================================================================================
+ */
+
+///
+/// Set dueling between lru, bestfit and camp (adaptivePolicy.c): each has a few leader
+/// sets, and every other set follows the one whose leaders missed least so far
+///
+extern const ReplacementPolicy adaptivePolicy;
+
+///
+/// Belady's OPT weighted by line size (optPolicy.c): evicts the line whose next use,
+/// looked up in an index built from the whole trace, is furthest per byte it frees.
+/// Offline only, an upper bound for the other policies
+///
+extern const ReplacementPolicy optPolicy;
 
 
 /* =====================================================================================
@@ -213,8 +475,45 @@ bool CAMPEvict(CacheSet *set, CompressedCacheLine *line, OutputInfo *info, FILE
  * =====================================================================================
  */
 
-char *generateOutputInfo(OutputInfo info);
+int openOutputWriter(OutputWriter *out, const char *filename, OutputFormat format, const char *policyName, SimSummary *summary);
+
+void writeOutputInfo(OutputWriter *out, const OutputInfo *info);
+
+void closeOutputWriter(OutputWriter *out);
+
+void updateSimSummary(SimSummary *summary, const OutputInfo *info);
+
+void mergeSimStats(SimStats *total, const SimStats *part);
+
+SimKernel selectSimKernel(const CacheGeometry *geometry);
+
+///
+/// Simulate the trace once against every context in contexts, which must share one
+/// policy. The trace is decoded once and each context's writer is opened here
+///
+void processTraceFile(SimContext *contexts, unsigned int contextCount, const char *filename, const SimOptions *options);
 
-void processTraceFile(Cache *cache, const char *filename, CompressionResult *compResult);
+///
+/// Simulate an already decoded trace against every context, collecting only the summary
+/// statistics. threads > 1 splits the sets of every cache across that many threads
+///
+void simulateTraceBuffer(SimContext *contexts, unsigned int contextCount, const TraceBuffer *trace, unsigned int threads);
+
+char *processTraceFileName(const char *filename, const char *policyName, const char *extension);
+
+
+/* =====================================================================================
+ * 
+ *                           Sweep functions
+ *  
+ * =====================================================================================
+ */
 
-char *processTraceFileName(const char *filename);
+///
+/// Decode every trace once, then simulate each trace x policy x geometry combination
+/// on a pool of threads and print one table with a row per combination. The table is
+/// also written to testOutput/sweep.csv. Every job draws from seed and compResult
+///
+void runSweep(char *const *traceNames, int traceCount, const ReplacementPolicy *const *policies, int policyCount,
+              const CacheGeometry *geometries, int geometryCount, unsigned long seed,
+              CompressionResult *compResult, unsigned int compResultCount, unsigned int epoch, unsigned int threads);
@@ -0,0 +1,639 @@
+/*
+ * compressors.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "compressors.h"
+
+// First byte of an FPC, C-Pack or BPC encoding
+#define FORMAT_STORED 0            // The line follows as is
+#define FORMAT_STREAM 1            // A bit stream, shorter than the line, follows
+
+#define CPACK_DICTIONARY 16        // FIFO of recently seen words
+#define BPC_CHUNK_WORDS 32         // BPC works on 128-byte blocks, longer lines are split
+
+// Bits are written and read most significant first. A writer without out only counts
+typedef struct {
+    unsigned char *out;
+    size_t bits;
+} BitWriter;
+
+typedef struct {
+    const unsigned char *in;
+    size_t bits;
+    size_t limit;                  // Bits the stream can hold, reading past it fails
+    bool overflow;
+} BitReader;
+
+/* =====================================================================================
+ *
+ *                           Bit stream helper functions
+ *
+ * =====================================================================================
+ */
+
+// Up to a byte at a time: the low count bits of value, most significant first
+static void putBits(BitWriter *writer, uint64_t value, unsigned int count) {
+    if (writer->out == NULL) {
+        writer->bits += count;
+        return;
+    }
+    while (count > 0) {
+        unsigned int room = 8 - (writer->bits & 7);
+        unsigned int take = count < room ? count : room;
+        unsigned char chunk = (value >> (count - take)) & ((1u << take) - 1);
+        unsigned char *byte = &(writer->out[writer->bits >> 3]);
+        *byte = (room == 8 ? 0 : *byte) | chunk << (room - take);
+        writer->bits += take;
+        count -= take;
+    }
+}
+
+static uint64_t getBits(BitReader *reader, unsigned int count) {
+    if (reader->bits + count > reader->limit) {
+        reader->overflow = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    while (count > 0) {
+        unsigned int room = 8 - (reader->bits & 7);
+        unsigned int take = count < room ? count : room;
+        unsigned int chunk = (reader->in[reader->bits >> 3] >> (room - take)) & ((1u << take) - 1);
+        value = (value << take) | chunk;
+        reader->bits += take;
+        count -= take;
+    }
+    return value;
+}
+
+static inline uint32_t readWord(const unsigned char *bytes, EndianType endianType) {
+    return (uint32_t)readBytesAsInteger(bytes, 4, endianType);
+}
+
+static inline void storeWord(unsigned char *bytes, uint32_t word, EndianType endianType) {
+    for (int i = 0; i < 4; i++) {
+        bytes[endianType == LITTLE ? i : 3 - i] = (word >> (8 * i)) & 0xFF;
+    }
+}
+
+static inline int64_t signExtendBits(uint64_t value, unsigned int bits) {
+    uint64_t sign = 1ULL << (bits - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+static inline bool fitsSigned(int64_t value, unsigned int bits) {
+    return value >= -(1LL << (bits - 1)) && value < (1LL << (bits - 1));
+}
+
+// isZero and isSame of a line of whole 32-bit words compressed to compSize bytes
+static CompressionResult wordResult(const unsigned char *line, unsigned lineSize, CompressorId algorithm, unsigned compSize) {
+    CompressionResult result = {1, 1, compSize, 0, 0, algorithm, compSize >= lineSize};
+    for (unsigned i = 0; i < lineSize; i++) {
+        result.isZero &= line[i] == 0;
+        result.isSame &= line[i] == line[i % 4];
+    }
+    result.isSame &= lineSize % 4 == 0;
+    return result;
+}
+
+/* =====================================================================================
+ *
+ *   Stream encodings shared by FPC, C-Pack and BPC: a format byte, then either the
+ *   line as is or, when strictly shorter than the line, the compressor's bit stream
+ *
+ * =====================================================================================
+ */
+
+typedef void (*StreamWriter)(const unsigned char *line, unsigned words, EndianType endianType, BitWriter *writer);
+typedef void (*StreamReader)(BitReader *reader, unsigned words, EndianType endianType, unsigned char *line);
+
+// Bytes of the bit stream, lineSize when the line is better stored as is
+static unsigned streamSize(StreamWriter write, const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    if (lineSize < 4 || lineSize % 4 != 0) {
+        return lineSize;
+    }
+    BitWriter counter = {NULL, 0};
+    write(line, lineSize / 4, endianType, &counter);
+    unsigned bytes = (counter.bits + 7) / 8;
+    return bytes < lineSize ? bytes : lineSize;
+}
+
+static unsigned encodeStream(StreamWriter write, const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out) {
+    unsigned bytes = streamSize(write, line, lineSize, endianType);
+    if (bytes == lineSize) {
+        out[0] = FORMAT_STORED;
+        memcpy(out + 1, line, lineSize);
+        return lineSize + 1;
+    }
+    out[0] = FORMAT_STREAM;
+    BitWriter writer = {out + 1, 0};
+    write(line, lineSize / 4, endianType, &writer);
+    return bytes + 1;
+}
+
+static unsigned decodeStream(StreamReader read, const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line) {
+    if (encoded[0] == FORMAT_STORED) {
+        memcpy(line, encoded + 1, lineSize);
+        return lineSize + 1;
+    }
+    if (encoded[0] != FORMAT_STREAM || lineSize < 4 || lineSize % 4 != 0) {
+        return 0;
+    }
+    // A stream is only written when it is shorter than the line
+    BitReader reader = {encoded + 1, 0, (size_t)(lineSize - 1) * 8, false};
+    read(&reader, lineSize / 4, endianType, line);
+    return reader.overflow ? 0 : (reader.bits + 7) / 8 + 1;
+}
+
+/* =====================================================================================
+ *
+ *   FPC: a 3-bit prefix per 32-bit word, then the bits the pattern keeps. Its size is
+ *   FPCCompress's estimate, which counts a byte per zero word and no zero runs
+ *
+ * =====================================================================================
+ */
+
+enum {
+    FPC_ZERO_RUN,                  // 3 bits: 1 to 8 zero words
+    FPC_SIGNED4,
+    FPC_SIGNED8,
+    FPC_SIGNED16,
+    FPC_HIGH_HALF,                 // Low halfword zero
+    FPC_SIGNED8_HALVES,            // Each halfword a sign-extended byte
+    FPC_REPEATED_BYTES,
+    FPC_UNCOMPRESSED
+};
+
+static void writeFPC(const unsigned char *line, unsigned words, EndianType endianType, BitWriter *writer) {
+    for (unsigned i = 0; i < words;) {
+        uint32_t word = readWord(line + 4 * i, endianType);
+        int32_t value = (int32_t)word;
+        if (word == 0) {
+            unsigned run = 1;
+            while (run < 8 && i + run < words && readWord(line + 4 * (i + run), endianType) == 0) {
+                run++;
+            }
+            putBits(writer, FPC_ZERO_RUN, 3);
+            putBits(writer, run - 1, 3);
+            i += run;
+            continue;
+        }
+        if (fitsSigned(value, 4)) {
+            putBits(writer, FPC_SIGNED4, 3);
+            putBits(writer, word & 0xF, 4);
+        } else if (fitsSigned(value, 8)) {
+            putBits(writer, FPC_SIGNED8, 3);
+            putBits(writer, word & 0xFF, 8);
+        } else if (fitsSigned(value, 16)) {
+            putBits(writer, FPC_SIGNED16, 3);
+            putBits(writer, word & 0xFFFF, 16);
+        } else if ((word & 0xFFFF) == 0) {
+            putBits(writer, FPC_HIGH_HALF, 3);
+            putBits(writer, word >> 16, 16);
+        } else if (fitsSigned((int16_t)(word >> 16), 8) && fitsSigned((int16_t)word, 8)) {
+            putBits(writer, FPC_SIGNED8_HALVES, 3);
+            putBits(writer, (word >> 16) & 0xFF, 8);
+            putBits(writer, word & 0xFF, 8);
+        } else if (word == (word & 0xFF) * 0x01010101u) {
+            putBits(writer, FPC_REPEATED_BYTES, 3);
+            putBits(writer, word & 0xFF, 8);
+        } else {
+            putBits(writer, FPC_UNCOMPRESSED, 3);
+            putBits(writer, word, 32);
+        }
+        i++;
+    }
+}
+
+static void readFPC(BitReader *reader, unsigned words, EndianType endianType, unsigned char *line) {
+    for (unsigned i = 0; i < words && !reader->overflow;) {
+        uint32_t word;
+        switch (getBits(reader, 3)) {
+            case FPC_ZERO_RUN: {
+                unsigned run = getBits(reader, 3) + 1;
+                if (i + run > words) {
+                    reader->overflow = true;
+                    return;
+                }
+                memset(line + 4 * i, 0, 4 * run);
+                i += run;
+                continue;
+            }
+            case FPC_SIGNED4:
+                word = signExtendBits(getBits(reader, 4), 4);
+                break;
+            case FPC_SIGNED8:
+                word = signExtendBits(getBits(reader, 8), 8);
+                break;
+            case FPC_SIGNED16:
+                word = signExtendBits(getBits(reader, 16), 16);
+                break;
+            case FPC_HIGH_HALF:
+                word = getBits(reader, 16) << 16;
+                break;
+            case FPC_SIGNED8_HALVES: {
+                uint32_t high = signExtendBits(getBits(reader, 8), 8) & 0xFFFF;
+                word = (high << 16) | (signExtendBits(getBits(reader, 8), 8) & 0xFFFF);
+                break;
+            }
+            case FPC_REPEATED_BYTES:
+                word = getBits(reader, 8) * 0x01010101u;
+                break;
+            default:
+                word = getBits(reader, 32);
+                break;
+        }
+        storeWord(line + 4 * i, word, endianType);
+        i++;
+    }
+}
+
+static CompressionResult fpcSize(const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    unsigned compSize = lineSize % 4 == 0 ? FPCCompress((unsigned char *)line, lineSize / 4, endianType) : lineSize;
+    return wordResult(line, lineSize, COMPRESSOR_FPC, compSize);
+}
+
+static unsigned fpcEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out) {
+    return encodeStream(writeFPC, line, lineSize, endianType, out);
+}
+
+static unsigned fpcDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line) {
+    return decodeStream(readFPC, encoded, lineSize, endianType, line);
+}
+
+/* =====================================================================================
+ *
+ *   C-Pack: each 32-bit word is zero, a small byte, or a full or partial match of a
+ *   16-entry FIFO dictionary. Words that are not a full match are pushed into it
+ *
+ * =====================================================================================
+ */
+
+typedef struct {
+    uint32_t words[CPACK_DICTIONARY];
+    unsigned count;
+    unsigned next;                 // Slot the next push overwrites
+} CPackDictionary;
+
+static void pushWord(CPackDictionary *dictionary, uint32_t word) {
+    dictionary->words[dictionary->next] = word;
+    dictionary->next = (dictionary->next + 1) % CPACK_DICTIONARY;
+    if (dictionary->count < CPACK_DICTIONARY) {
+        dictionary->count++;
+    }
+}
+
+// First entry that equals word in the bits of mask, -1 if none
+static int findWord(const CPackDictionary *dictionary, uint32_t word, uint32_t mask) {
+    for (unsigned i = 0; i < dictionary->count; i++) {
+        if (((dictionary->words[i] ^ word) & mask) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Codes: zzzz 00, xxxx 01 + word, mmmm 10 + index, mmxx 1100 + index + low halfword,
+// zzzx 1101 + low byte, mmmx 1110 + index + low byte
+static void writeCPack(const unsigned char *line, unsigned words, EndianType endianType, BitWriter *writer) {
+    CPackDictionary dictionary = {{0}, 0, 0};
+    for (unsigned i = 0; i < words; i++) {
+        uint32_t word = readWord(line + 4 * i, endianType);
+        int index;
+        if (word == 0) {
+            putBits(writer, 0x0, 2);
+        } else if ((index = findWord(&dictionary, word, 0xFFFFFFFF)) >= 0) {
+            putBits(writer, 0x2, 2);
+            putBits(writer, index, 4);
+        } else if (word <= 0xFF) {
+            putBits(writer, 0xD, 4);
+            putBits(writer, word, 8);
+        } else if ((index = findWord(&dictionary, word, 0xFFFFFF00)) >= 0) {
+            putBits(writer, 0xE, 4);
+            putBits(writer, index, 4);
+            putBits(writer, word & 0xFF, 8);
+            pushWord(&dictionary, word);
+        } else if ((index = findWord(&dictionary, word, 0xFFFF0000)) >= 0) {
+            putBits(writer, 0xC, 4);
+            putBits(writer, index, 4);
+            putBits(writer, word & 0xFFFF, 16);
+            pushWord(&dictionary, word);
+        } else {
+            putBits(writer, 0x1, 2);
+            putBits(writer, word, 32);
+            pushWord(&dictionary, word);
+        }
+    }
+}
+
+static void readCPack(BitReader *reader, unsigned words, EndianType endianType, unsigned char *line) {
+    CPackDictionary dictionary = {{0}, 0, 0};
+    for (unsigned i = 0; i < words && !reader->overflow; i++) {
+        uint32_t word;
+        unsigned code = getBits(reader, 2);
+        if (code == 0x3) {
+            code = 0xC | getBits(reader, 2);
+        }
+        if (code == 0x0) {
+            word = 0;
+        } else if (code == 0xD) {
+            word = getBits(reader, 8);
+        } else if (code == 0x1) {
+            word = getBits(reader, 32);
+            pushWord(&dictionary, word);
+        } else if (code == 0xF) {
+            reader->overflow = true;
+            return;
+        } else {
+            unsigned index = getBits(reader, 4);
+            if (index >= dictionary.count) {
+                reader->overflow = true;
+                return;
+            }
+            word = dictionary.words[index];
+            if (code == 0xE) {
+                word = (word & 0xFFFFFF00) | getBits(reader, 8);
+                pushWord(&dictionary, word);
+            } else if (code == 0xC) {
+                word = (word & 0xFFFF0000) | getBits(reader, 16);
+                pushWord(&dictionary, word);
+            }
+        }
+        storeWord(line + 4 * i, word, endianType);
+    }
+}
+
+static CompressionResult cpackSize(const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    return wordResult(line, lineSize, COMPRESSOR_CPACK, streamSize(writeCPack, line, lineSize, endianType));
+}
+
+static unsigned cpackEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out) {
+    return encodeStream(writeCPack, line, lineSize, endianType, out);
+}
+
+static unsigned cpackDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line) {
+    return decodeStream(readCPack, encoded, lineSize, endianType, line);
+}
+
+/* =====================================================================================
+ *
+ *   Bit-Plane Compression: per block of up to 32 words, the first word as a base and
+ *   the 33-bit deltas between neighbours turned into bit planes. Each plane is XORed
+ *   with the one above it and runs of zero planes or planes with one or two set bits
+ *   get short codes
+ *
+ * =====================================================================================
+ */
+
+#define BPC_PLANES 33
+
+// Base: 000 zero, 001 + 4 bits, 010 + 8 bits, 011 + 16 bits (sign-extended), 1 + word
+static void writeBPCBase(BitWriter *writer, uint32_t word) {
+    int32_t value = (int32_t)word;
+    if (word == 0) {
+        putBits(writer, 0x0, 3);
+    } else if (fitsSigned(value, 4)) {
+        putBits(writer, 0x1, 3);
+        putBits(writer, word & 0xF, 4);
+    } else if (fitsSigned(value, 8)) {
+        putBits(writer, 0x2, 3);
+        putBits(writer, word & 0xFF, 8);
+    } else if (fitsSigned(value, 16)) {
+        putBits(writer, 0x3, 3);
+        putBits(writer, word & 0xFFFF, 16);
+    } else {
+        putBits(writer, 0x1, 1);
+        putBits(writer, word, 32);
+    }
+}
+
+static uint32_t readBPCBase(BitReader *reader) {
+    static const unsigned int widths[] = {0, 4, 8, 16};
+    if (getBits(reader, 1)) {
+        return getBits(reader, 32);
+    }
+    unsigned int width = widths[getBits(reader, 2)];
+    return width == 0 ? 0 : (uint32_t)signExtendBits(getBits(reader, width), width);
+}
+
+// Plane codes, top plane first: 001 + 5-bit (run - 2) for 2 to 33 zero planes, 01 for one,
+// 00000 all ones, 00001 delta plane zero, 00010 + position for two adjacent ones,
+// 00011 + position for a single one, 1 + the plane as is
+static void writeBPCBlock(const unsigned char *line, unsigned words, EndianType endianType, BitWriter *writer) {
+    uint32_t previous = readWord(line, endianType);
+    writeBPCBase(writer, previous);
+    unsigned deltas = words - 1;
+    if (deltas == 0) {
+        return;
+    }
+
+    uint32_t planes[BPC_PLANES] = {0};     // Bit j of planes[b]: bit b of delta j
+    for (unsigned j = 0; j < deltas; j++) {
+        uint32_t word = readWord(line + 4 * (j + 1), endianType);
+        uint64_t delta = (uint64_t)((int64_t)word - (int64_t)previous);
+        for (unsigned b = 0; b < BPC_PLANES; b++) {
+            planes[b] |= (uint32_t)((delta >> b) & 1) << j;
+        }
+        previous = word;
+    }
+
+    uint32_t full = deltas == 32 ? UINT32_MAX : (1u << deltas) - 1;
+    for (int b = BPC_PLANES - 1; b >= 0;) {
+        uint32_t xored = planes[b] ^ (b == BPC_PLANES - 1 ? 0 : planes[b + 1]);
+        if (xored == 0) {
+            int run = 1;
+            while (b - run >= 0 && (planes[b - run] ^ planes[b - run + 1]) == 0) {
+                run++;
+            }
+            if (run == 1) {
+                putBits(writer, 0x1, 2);
+            } else {
+                putBits(writer, 0x1, 3);
+                putBits(writer, run - 2, 5);
+            }
+            b -= run;
+            continue;
+        }
+        unsigned position = __builtin_ctz(xored);
+        if (xored == full) {
+            putBits(writer, 0x0, 5);
+        } else if (planes[b] == 0) {
+            putBits(writer, 0x1, 5);
+        } else if (xored >> position == 0x3) {
+            putBits(writer, 0x2, 5);
+            putBits(writer, position, 5);
+        } else if (xored >> position == 0x1) {
+            putBits(writer, 0x3, 5);
+            putBits(writer, position, 5);
+        } else {
+            putBits(writer, 0x1, 1);
+            putBits(writer, xored, deltas);
+        }
+        b--;
+    }
+}
+
+static void readBPCBlock(BitReader *reader, unsigned words, EndianType endianType, unsigned char *line) {
+    uint32_t previous = readBPCBase(reader);
+    storeWord(line, previous, endianType);
+    unsigned deltas = words - 1;
+    if (deltas == 0) {
+        return;
+    }
+
+    uint32_t planes[BPC_PLANES];
+    uint32_t full = deltas == 32 ? UINT32_MAX : (1u << deltas) - 1;
+    uint32_t above = 0;
+    for (int b = BPC_PLANES - 1; b >= 0 && !reader->overflow;) {
+        if (getBits(reader, 1)) {
+            planes[b] = (getBits(reader, deltas) ^ above) & full;
+        } else if (getBits(reader, 1)) {
+            planes[b] = above;
+        } else if (getBits(reader, 1)) {
+            int run = getBits(reader, 5) + 2;
+            if (run > b + 1) {
+                reader->overflow = true;
+                return;
+            }
+            for (int r = 0; r < run; r++) {
+                planes[b - r] = above;
+            }
+            b -= run;
+            continue;
+        } else {
+            unsigned code = getBits(reader, 2);
+            uint32_t xored = code == 0x0 ? full : 0;
+            if (code >= 0x2) {
+                unsigned position = getBits(reader, 5);
+                xored = (code == 0x2 ? 0x3u : 0x1u) << position;
+                if (position >= deltas || (code == 0x2 && position + 1 >= deltas)) {
+                    reader->overflow = true;
+                    return;
+                }
+            }
+            planes[b] = code == 0x1 ? 0 : xored ^ above;
+        }
+        above = planes[b];
+        b--;
+    }
+
+    for (unsigned j = 0; j < deltas; j++) {
+        uint64_t delta = 0;
+        for (unsigned b = 0; b < BPC_PLANES; b++) {
+            delta |= (uint64_t)((planes[b] >> j) & 1) << b;
+        }
+        previous += (uint32_t)signExtendBits(delta, BPC_PLANES);
+        storeWord(line + 4 * (j + 1), previous, endianType);
+    }
+}
+
+static void writeBPC(const unsigned char *line, unsigned words, EndianType endianType, BitWriter *writer) {
+    for (unsigned i = 0; i < words; i += BPC_CHUNK_WORDS) {
+        unsigned blockWords = words - i < BPC_CHUNK_WORDS ? words - i : BPC_CHUNK_WORDS;
+        writeBPCBlock(line + 4 * i, blockWords, endianType, writer);
+    }
+}
+
+static void readBPC(BitReader *reader, unsigned words, EndianType endianType, unsigned char *line) {
+    for (unsigned i = 0; i < words && !reader->overflow; i += BPC_CHUNK_WORDS) {
+        unsigned blockWords = words - i < BPC_CHUNK_WORDS ? words - i : BPC_CHUNK_WORDS;
+        readBPCBlock(reader, blockWords, endianType, line + 4 * i);
+    }
+}
+
+static CompressionResult bpcSize(const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    return wordResult(line, lineSize, COMPRESSOR_BPC, streamSize(writeBPC, line, lineSize, endianType));
+}
+
+static unsigned bpcEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out) {
+    return encodeStream(writeBPC, line, lineSize, endianType, out);
+}
+
+static unsigned bpcDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line) {
+    return decodeStream(readBPC, encoded, lineSize, endianType, line);
+}
+
+/* =====================================================================================
+ *
+ *                           BDI and best-of
+ *
+ * =====================================================================================
+ */
+
+// What BDIEncode writes, so BDI competes with the others on bytes it can actually store
+static CompressionResult bdiSize(const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    return BDIEncodedResult(line, lineSize, endianType);
+}
+
+// The smallest size of the other compressors, the first of them on a tie
+static CompressionResult bestSize(const unsigned char *line, unsigned lineSize, EndianType endianType) {
+    CompressionResult best = compressors[0]->size(line, lineSize, endianType);
+    for (int i = 1; i < COMPRESSOR_BEST; i++) {
+        CompressionResult result = compressors[i]->size(line, lineSize, endianType);
+        if (result.compSize < best.compSize) {
+            best = result;
+        }
+    }
+    return best;
+}
+
+// The winner's id, then its encoding
+static unsigned bestEncode(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out) {
+    CompressionResult best = bestSize(line, lineSize, endianType);
+    out[0] = best.algorithm;
+    return compressors[best.algorithm]->encode(line, lineSize, endianType, out + 1) + 1;
+}
+
+static unsigned bestDecode(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line) {
+    if (encoded[0] >= COMPRESSOR_BEST) {
+        return 0;
+    }
+    unsigned bytes = compressors[encoded[0]]->decode(encoded + 1, lineSize, endianType, line);
+    return bytes == 0 ? 0 : bytes + 1;
+}
+
+// Decode cycles: BDI 1, FPC 5 (a five-stage pipeline), C-Pack 8, BPC 7. Lines kept
+// uncompressed cost none, best-of lines are charged their winner's latency
+const Compressor bdiCompressor = {"bdi", 1, bdiSize, BDIEncode, BDIDecode};
+const Compressor fpcCompressor = {"fpc", 5, fpcSize, fpcEncode, fpcDecode};
+const Compressor cpackCompressor = {"cpack", 8, cpackSize, cpackEncode, cpackDecode};
+const Compressor bpcCompressor = {"bpc", 7, bpcSize, bpcEncode, bpcDecode};
+const Compressor bestCompressor = {"best", 0, bestSize, bestEncode, bestDecode};
+
+const Compressor *const compressors[] = {
+    [COMPRESSOR_BDI] = &bdiCompressor,
+    [COMPRESSOR_FPC] = &fpcCompressor,
+    [COMPRESSOR_CPACK] = &cpackCompressor,
+    [COMPRESSOR_BPC] = &bpcCompressor,
+    [COMPRESSOR_BEST] = &bestCompressor,
+    [COMPRESSORS] = NULL
+};
+
+const Compressor *findCompressor(const char *name) {
+    for (int i = 0; compressors[i] != NULL; i++) {
+        if (strcmp(name, compressors[i]->name) == 0) {
+            return compressors[i];
+        }
+    }
+    return NULL;
+}
+
+void compressHexFile(const char *filename, EndianType endianType, const Compressor *compressor, CompressionResult *compResult) {
+    BufferStruct bufferStruct = readHexValuesIntoBuffer(filename);
+    if (bufferStruct.buffer == NULL) {
+        perror("Failed to read buffer from file.");
+        exit(EXIT_FAILURE);
+    }
+    if (compressor == NULL) {
+        *compResult = BDICompress(bufferStruct.buffer, bufferStruct.size, endianType);
+    } else {
+        *compResult = compressor->size(bufferStruct.buffer, bufferStruct.size, endianType);
+    }
+    free(bufferStruct.buffer);
+}
@@ -0,0 +1,59 @@
+/*
+ * compressors.h
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#ifndef _COMPRESSORS_H_
+#define _COMPRESSORS_H_
+
+#include "bdi.h"
+
+// Bytes an encoded line can take: the line itself, a format byte and best-of's id byte
+#define MAX_ENCODED_SIZE(lineSize) ((lineSize) + 2)
+
+///
+/// A line compressor. size is what the simulator charges a line, encode writes the real
+/// compressed bytes (at most MAX_ENCODED_SIZE) and decode restores lineSize bytes from
+/// them, returning the bytes consumed or 0 for input it cannot have written. Every hit
+/// on a line it compressed costs decodeCycles, the hardware decompression latency
+/// published with the algorithm; lines it kept uncompressed (stored) cost nothing
+///
+typedef struct {
+    const char *name;
+    unsigned decodeCycles;
+    CompressionResult (*size)(const unsigned char *line, unsigned lineSize, EndianType endianType);
+    unsigned (*encode)(const unsigned char *line, unsigned lineSize, EndianType endianType, unsigned char *out);
+    unsigned (*decode)(const unsigned char *encoded, unsigned lineSize, EndianType endianType, unsigned char *line);
+} Compressor;
+
+typedef enum {
+    COMPRESSOR_BDI,
+    COMPRESSOR_FPC,
+    COMPRESSOR_CPACK,
+    COMPRESSOR_BPC,
+    COMPRESSOR_BEST,
+    COMPRESSORS
+} CompressorId;
+
+extern const Compressor bdiCompressor;
+extern const Compressor fpcCompressor;
+extern const Compressor cpackCompressor;
+extern const Compressor bpcCompressor;
+extern const Compressor bestCompressor;   // Smallest of the others, which it records in algorithm
+
+///
+/// Indexed by CompressorId, the algorithm of a CompressionResult, and NULL-terminated
+///
+extern const Compressor *const compressors[];
+
+const Compressor *findCompressor(const char *name);
+
+///
+/// Compress the hex dump in filename (one 32-bit word per line) as one line. A NULL
+/// compressor sizes it with BDICompress, the BDI estimate the default runs are charged
+///
+void compressHexFile(const char *filename, EndianType endianType, const Compressor *compressor, CompressionResult *compResult);
+
+#endif
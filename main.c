@@ -2,50 +2,249 @@
  * main.c
  * 
  * Created by Penggao Li
- * Last modified: 04/29/2024
+ * Last modified: 10/17/2026
  */
 
+#include <getopt.h>
+
 #include "compressedCache.h"
 
 /* =====================================================================================
  * 
- *                               Global variables
+ *                               main function
  *  
  * =====================================================================================
  */
 
-int diff = INT_MAX;
-double closest = 0;
+// Parse "8,16,32" into sizes, returns the number of sizes or -1
+static int parseSizeList(const char *list, unsigned int *sizes, int maxSizes) {
+    int count = 0;
+    const char *p = list;
+    for (;;) {
+        char *end;
+        unsigned long size = strtoul(p, &end, 10);
+        if (end == p || count == maxSizes) {
+            return -1;
+        }
+        sizes[count++] = size;
+        if (*end == '\0') {
+            return count;
+        }
+        if (*end != ',') {
+            return -1;
+        }
+        p = end + 1;
+    }
+}
 
-long instructionCount = 0;
-long loadCount = 0;
-long loadHitCount = 0;
-long storeCount = 0;
-long storeHitCount = 0;
+// Parse "lru,camp" (or "all") into policies, returns the number of policies or -1
+static int parsePolicyList(const char *list, const ReplacementPolicy **policies, int maxPolicies) {
+    if (strcmp(list, "all") == 0) {
+        int count = 0;
+        for (; replacementPolicies[count] != NULL && count < maxPolicies; count++) {
+            policies[count] = replacementPolicies[count];
+        }
+        return count;
+    }
+    char name[32];
+    int count = 0;
+    const char *p = list;
+    for (;;) {
+        size_t length = strcspn(p, ",");
+        if (length >= sizeof(name) || count == maxPolicies) {
+            return -1;
+        }
+        memcpy(name, p, length);
+        name[length] = '\0';
+        if ((policies[count++] = findReplacementPolicy(name)) == NULL) {
+            return -1;
+        }
+        if (p[length] == '\0') {
+            return count;
+        }
+        p += length + 1;
+    }
+}
 
-ReplacementPolicy RP = LRU;
+static void printUsage(const char *program) {
+    printf("Usage: %s [options] [tracefile]\n", program);
+    printf("       %s --sweep POLICIES [options] tracefile...\n", program);
+    printf("  -p, --pipeline   decode the trace on a separate reader thread\n");
+    printf("  -f, --format F   per-access output: csv (default), columnar or summary\n");
+    printf("  -j, --threads N  split the cache sets across N threads (summary output only)\n");
+    printf("  -c, --cache-size KB  cache size in KB (default %d), a comma-separated list\n", DEFAULT_CACHE_SIZE_KB);
+    printf("                       simulates every size in one pass over the trace\n");
+    printf("  -l, --line-size B    line size in bytes (default %d)\n", DEFAULT_LINE_SIZE);
+    printf("  -a, --assoc N        lines per set (default %d)\n", DEFAULT_SET_ASSOCIATIVITY);
+    printf("                       -l and -a also take lists, every size x line x assoc is simulated\n");
+    printf("  -e, --epoch N    accesses between two training steps of CAMP, DRRIP, SIP and ECM\n");
+    printf("                   (default %d)\n", POLICY_EPOCH);
+    printf("  -r, --seed N     seed for line contents and RANDOM eviction (default: the time)\n");
+    printf("  -z, --compressor C   compressor sizing the lines by what it encodes: bdi, fpc,\n");
+    printf("                       cpack, bpc or best, which keeps the smallest and records\n");
+    printf("                       which one won (default: the BDI estimate of BDICompress)\n");
+    printf("  -s, --sweep P    run every policy in P (e.g. lru,camp or all) on every geometry\n");
+    printf("                   and trace on a pool of -j threads (default: all cores), then\n");
+    printf("                   print one table, also written to testOutput/sweep.csv\n");
+    printf("  -h, --help       show this message\n");
+    printf("The trace file name is asked for interactively when it is not given.\n");
+}
 
-/* =====================================================================================
- * 
- *                               main function
- *  
- * =====================================================================================
- */
+int main(int argc, char *argv[]) {
 
-int main() {
+    SimOptions options = {false, OUTPUT_CSV, 1};
+    bool formatGiven = false;
+    unsigned int cacheSizes[MAX_CACHE_CONFIGS] = {DEFAULT_CACHE_SIZE_KB};
+    int cacheCount = 1;
+    unsigned int lineSizes[MAX_CACHE_CONFIGS] = {DEFAULT_LINE_SIZE};
+    int lineCount = 1;
+    unsigned int associativities[MAX_CACHE_CONFIGS] = {DEFAULT_SET_ASSOCIATIVITY};
+    int associativityCount = 1;
+    const ReplacementPolicy *policies[MAX_REPLACEMENT_POLICIES];
+    int policyCount = 0;           // > 0 selects sweep mode
+    bool threadsGiven = false;
+    unsigned long seed = time(0);
+    unsigned int epoch = POLICY_EPOCH;
+    const Compressor *compressor = NULL;    // BDICompress estimate
 
-    char traceName[64];
-    // default test trace: "testTraces/test.trace";
+    static const struct option longOptions[] = {
+        {"pipeline", no_argument, NULL, 'p'},
+        {"format", required_argument, NULL, 'f'},
+        {"threads", required_argument, NULL, 'j'},
+        {"cache-size", required_argument, NULL, 'c'},
+        {"line-size", required_argument, NULL, 'l'},
+        {"assoc", required_argument, NULL, 'a'},
+        {"epoch", required_argument, NULL, 'e'},
+        {"seed", required_argument, NULL, 'r'},
+        {"compressor", required_argument, NULL, 'z'},
+        {"sweep", required_argument, NULL, 's'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
 
-    printf("Enter the trace file name: ");
-    if (fgets(traceName, sizeof(traceName), stdin) == NULL) {
-        printf("Error reading input.\n");
-        return 1;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "pf:j:c:l:a:e:r:z:s:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'p':
+            options.pipelined = true;
+            break;
+            case 'f':
+            if (strcmp(optarg, "csv") == 0) {
+                options.outputFormat = OUTPUT_CSV;
+            } else if (strcmp(optarg, "columnar") == 0) {
+                options.outputFormat = OUTPUT_COLUMNAR;
+            } else if (strcmp(optarg, "summary") == 0) {
+                options.outputFormat = OUTPUT_SUMMARY;
+            } else {
+                fprintf(stderr, "Unknown output format: %s\n", optarg);
+                return 1;
+            }
+            formatGiven = true;
+            break;
+            case 'j':
+            options.threads = strtoul(optarg, NULL, 10);
+            if (options.threads == 0) {
+                fprintf(stderr, "Expected a positive thread count: %s\n", optarg);
+                return 1;
+            }
+            threadsGiven = true;
+            break;
+            case 'c':
+            cacheCount = parseSizeList(optarg, cacheSizes, MAX_CACHE_CONFIGS);
+            if (cacheCount < 0) {
+                fprintf(stderr, "Expected up to %d comma-separated cache sizes: %s\n", MAX_CACHE_CONFIGS, optarg);
+                return 1;
+            }
+            break;
+            case 'l':
+            lineCount = parseSizeList(optarg, lineSizes, MAX_CACHE_CONFIGS);
+            if (lineCount < 0) {
+                fprintf(stderr, "Expected up to %d comma-separated line sizes: %s\n", MAX_CACHE_CONFIGS, optarg);
+                return 1;
+            }
+            break;
+            case 'a':
+            associativityCount = parseSizeList(optarg, associativities, MAX_CACHE_CONFIGS);
+            if (associativityCount < 0) {
+                fprintf(stderr, "Expected up to %d comma-separated associativities: %s\n", MAX_CACHE_CONFIGS, optarg);
+                return 1;
+            }
+            break;
+            case 'e':
+            epoch = strtoul(optarg, NULL, 10);
+            if (epoch == 0) {
+                fprintf(stderr, "Expected a positive epoch: %s\n", optarg);
+                return 1;
+            }
+            break;
+            case 'r': {
+            char *end;
+            seed = strtoul(optarg, &end, 0);
+            if (end == optarg || *end != '\0') {
+                fprintf(stderr, "Expected a numeric seed: %s\n", optarg);
+                return 1;
+            }
+            break;
+            }
+            case 'z':
+            compressor = findCompressor(optarg);
+            if (compressor == NULL) {
+                fprintf(stderr, "Expected one of the compressors (");
+                for (int i = 0; compressors[i] != NULL; i++) {
+                    fprintf(stderr, "%s%s", i == 0 ? "" : ", ", compressors[i]->name);
+                }
+                fprintf(stderr, "): %s\n", optarg);
+                return 1;
+            }
+            break;
+            case 's':
+            policyCount = parsePolicyList(optarg, policies, MAX_REPLACEMENT_POLICIES);
+            if (policyCount < 0) {
+                fprintf(stderr, "Expected comma-separated policies (");
+                for (int i = 0; replacementPolicies[i] != NULL; i++) {
+                    fprintf(stderr, "%s%s", i == 0 ? "" : ", ", replacementPolicies[i]->name);
+                }
+                fprintf(stderr, ") or all: %s\n", optarg);
+                return 1;
+            }
+            break;
+            case 'h':
+            printUsage(argv[0]);
+            return 0;
+            default:
+            printUsage(argv[0]);
+            return 1;
+        }
     }
 
-    traceName[strcspn(traceName, "\n")] = 0;  // Remove newline character
+    if (options.threads > 1) {
+        // Shards finish out of trace order, so there is no per-access file to write
+        if (formatGiven && options.outputFormat != OUTPUT_SUMMARY) {
+            fprintf(stderr, "-j only supports -f summary\n");
+            return 1;
+        }
+        options.outputFormat = OUTPUT_SUMMARY;
+    }
 
-    RP = chooseReplacementPolicy();
+    if (cacheCount * lineCount * associativityCount > MAX_CACHE_CONFIGS) {
+        fprintf(stderr, "At most %d geometries can be simulated together\n", MAX_CACHE_CONFIGS);
+        return 1;
+    }
+    CacheGeometry geometries[MAX_CACHE_CONFIGS];
+    int geometryCount = 0;
+    unsigned int minLineSize = UINT_MAX;
+    for (int c = 0; c < cacheCount; c++) {
+        for (int l = 0; l < lineCount; l++) {
+            for (int a = 0; a < associativityCount; a++) {
+                if (initializeCacheGeometry(&geometries[geometryCount++], cacheSizes[c], lineSizes[l], associativities[a]) != 0) {
+                    return 1;
+                }
+            }
+            if (lineSizes[l] < minLineSize) {
+                minLineSize = lineSizes[l];
+            }
+        }
+    }
 
     const char *filename1 = "testHex/hex1.txt";
     const char *filename2 = "testHex/hex2.txt";
@@ -54,30 +253,78 @@ int main() {
     const char *filename5 = "testHex/hex5.txt";
     
     CompressionResult compResult[5];
-    generateCompressedData(filename1, &compResult[0]);
-    generateCompressedData(filename2, &compResult[1]);
-    generateCompressedData(filename3, &compResult[2]);
-    generateCompressedData(filename4, &compResult[3]);
-    generateCompressedData(filename5, &compResult[4]);
+    compressHexFile(filename1, BIG, compressor, &compResult[0]);
+    compressHexFile(filename2, BIG, compressor, &compResult[1]);
+    compressHexFile(filename3, BIG, compressor, &compResult[2]);
+    compressHexFile(filename4, BIG, compressor, &compResult[3]);
+    compressHexFile(filename5, BIG, compressor, &compResult[4]);
+    printf("Using compressor: %s\n", compressor == NULL ? "bdi (estimate)" : compressor->name);
+
+    for (int i = 0; i < 5; i++) {
+        // A compressed line never takes more room than an uncompressed one
+        if (((compResult[i].compSize + 3) & ~3u) > minLineSize) {
+            fprintf(stderr, "Sample %d compresses to %u bytes, more than a %u-byte line\n", i + 1, compResult[i].compSize, minLineSize);
+            return 1;
+        }
+    }
+
+    if (policyCount > 0) {
+        if (optind == argc) {
+            fprintf(stderr, "--sweep needs at least one trace file\n");
+            return 1;
+        }
+        unsigned int threads = threadsGiven ? options.threads : (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+        runSweep(argv + optind, argc - optind, policies, policyCount, geometries, geometryCount, seed, compResult, 5, epoch, threads);
+        return 0;
+    }
+
+    char traceName[256];
+    // default test trace: "testTraces/test.trace";
 
-    Cache cache;
-    initializeCache(&cache);
+    if (optind < argc) {
+        snprintf(traceName, sizeof(traceName), "%s", argv[optind]);
+    } else {
+        printf("Enter the trace file name: ");
+        if (fgets(traceName, sizeof(traceName), stdin) == NULL) {
+            printf("Error reading input.\n");
+            return 1;
+        }
+
+        traceName[strcspn(traceName, "\n")] = 0;  // Remove newline character
+    }
+
+    const ReplacementPolicy *policy = chooseReplacementPolicy();
+
+    Cache caches[MAX_CACHE_CONFIGS];
+    SimContext contexts[MAX_CACHE_CONFIGS];
+    for (int i = 0; i < geometryCount; i++) {
+        initializeCache(&caches[i], &geometries[i], policy);
+        initializeSimContext(&contexts[i], &caches[i], seed, compResult, 5);
+        contexts[i].epoch = epoch;
+    }
 
     clock_t start, end;
     double cpu_time_used;
 
     start = clock();
     
-    processTraceFile(&cache, traceName, compResult);
+    processTraceFile(contexts, geometryCount, traceName, &options);
 
-    printSimResult(traceName);
+    for (int i = 0; i < geometryCount; i++) {
+        printSimResult(&contexts[i], traceName);
+    }
+    if (geometryCount > 1) {
+        printMissRatioCurve(contexts, geometryCount);
+    }
 
     end = clock();
     cpu_time_used = ((double) (end - start)) / CLOCKS_PER_SEC;
 
     printf("Execution time: %f seconds\n", cpu_time_used);
 
-    freeCache(&cache);
+    for (int i = 0; i < geometryCount; i++) {
+        freeCache(&caches[i]);
+    }
     printf("Cache has been successfully freed.\n");
     return 0;
 }
@@ -0,0 +1,218 @@
+/*
+ * optPolicy.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include "compressedCache.h"
+
+#define NO_NEXT_USE UINT32_MAX         // The line is never accessed again
+#define NEVER_REUSED (1ULL << 33)      // Distance of a line with NO_NEXT_USE, past any trace
+#define LINE_TABLE_MIN_BITS 12
+
+// Depends only on the trace and the line size, so caches with the same line size share it
+typedef struct {
+    unsigned int offsetBits;
+    uint32_t *nextUse;                 // nextUse[i]: next record to access record i's line
+    size_t records;
+    size_t lines;                      // Distinct lines in the trace
+    unsigned int users;                // Caches holding it, the last one frees it
+} NextUseIndex;
+
+typedef struct {
+    unsigned int offsetBits;
+    unsigned int linesPerSet;
+    NextUseIndex *index;               // Read-only while simulating
+    uint32_t *slotNextUse;             // Next use of the line in every slot of the cache
+} OptState;
+
+// Open-addressed map from a line address to the last record seen accessing it
+typedef struct {
+    uint32_t line;
+    uint32_t record;
+} LineEntry;
+
+typedef struct {
+    LineEntry *entries;
+    unsigned int bits;
+    size_t used;
+} LineTable;
+
+/* =====================================================================================
+ *
+ *                           Next-use index functions
+ *
+ * =====================================================================================
+ */
+
+static void initializeLineTable(LineTable *table, unsigned int bits) {
+    table->entries = malloc(((size_t)1 << bits) * sizeof(LineEntry));
+    if (table->entries == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    memset(table->entries, 0xff, ((size_t)1 << bits) * sizeof(LineEntry));  // line UINT32_MAX: empty
+    table->bits = bits;
+    table->used = 0;
+}
+
+static LineEntry *findLineEntry(LineTable *table, uint32_t line) {
+    size_t mask = ((size_t)1 << table->bits) - 1;
+    size_t i = (uint32_t)(line * 0x9E3779B1u) >> (32 - table->bits);
+    while (table->entries[i].line != line && table->entries[i].line != UINT32_MAX) {
+        i = (i + 1) & mask;
+    }
+    return &(table->entries[i]);
+}
+
+// Double the table once it is half full, so probes stay short
+static void growLineTable(LineTable *table) {
+    LineTable grown;
+    initializeLineTable(&grown, table->bits + 1);
+    for (size_t i = 0; i < ((size_t)1 << table->bits); i++) {
+        if (table->entries[i].line != UINT32_MAX) {
+            *findLineEntry(&grown, table->entries[i].line) = table->entries[i];
+        }
+    }
+    grown.used = table->used;
+    free(table->entries);
+    *table = grown;
+}
+
+// One reverse pass: the last record seen accessing a line is the next use of the
+// current record. The index keeps 4 bytes per record. While it is built, the line table
+// adds 16 to 32 bytes per distinct line (8-byte entries, grown by doubling once half
+// full), freed before returning
+static NextUseIndex *buildNextUse(unsigned int offsetBits, const TraceBuffer *trace) {
+    if (trace->count >= NO_NEXT_USE) {
+        fprintf(stderr, "Trace too long for the next-use index: %zu records\n", trace->count);
+        exit(EXIT_FAILURE);
+    }
+    NextUseIndex *index = malloc(sizeof(NextUseIndex));
+    if (index != NULL) {
+        index->nextUse = malloc((trace->count + 1) * sizeof(uint32_t));
+    }
+    if (index == NULL || index->nextUse == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    index->offsetBits = offsetBits;
+    index->records = trace->count;
+    index->users = 1;
+
+    LineTable table;
+    initializeLineTable(&table, LINE_TABLE_MIN_BITS);
+    for (size_t i = trace->count; i-- > 0;) {
+        uint32_t line = (addr_32_bit)trace->records[i].address >> offsetBits;
+        LineEntry *entry = findLineEntry(&table, line);
+        if (entry->line == UINT32_MAX) {
+            entry->line = line;
+            index->nextUse[i] = NO_NEXT_USE;
+            if (2 * ++table.used > ((size_t)1 << table.bits)) {
+                growLineTable(&table);
+                entry = findLineEntry(&table, line);
+            }
+        } else {
+            index->nextUse[i] = entry->record;
+        }
+        entry->record = i;
+    }
+    index->lines = table.used;
+    free(table.entries);
+    return index;
+}
+
+static void releaseNextUse(NextUseIndex *index) {
+    if (index != NULL && --index->users == 0) {
+        free(index->nextUse);
+        free(index);
+    }
+}
+
+/* =====================================================================================
+ *
+ *                           OPT policy functions
+ *
+ * =====================================================================================
+ */
+
+static void *createOptState(const CacheGeometry *geometry) {
+    OptState *state = calloc(1, sizeof(OptState));
+    size_t slots = (size_t)geometry->numberOfSets * geometry->linesPerSet;
+    if (state != NULL) {
+        state->slotNextUse = malloc(slots * sizeof(uint32_t));
+    }
+    if (state == NULL || state->slotNextUse == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    state->offsetBits = geometry->offsetBits;
+    state->linesPerSet = geometry->linesPerSet;
+    return state;
+}
+
+static void freeOptState(void *arg) {
+    OptState *state = arg;
+    releaseNextUse(state->index);
+    free(state->slotNextUse);
+    free(state);
+}
+
+// One index per line size, built by the first cache that needs it
+static void optPrepare(Cache *const *caches, unsigned int cacheCount, const TraceBuffer *trace) {
+    for (unsigned int c = 0; c < cacheCount; c++) {
+        OptState *state = caches[c]->policyState;
+        releaseNextUse(state->index);
+        state->index = NULL;
+        for (unsigned int p = 0; p < c && state->index == NULL; p++) {
+            NextUseIndex *shared = ((OptState *)caches[p]->policyState)->index;
+            if (shared->offsetBits == state->offsetBits) {
+                shared->users++;
+                state->index = shared;
+            }
+        }
+        if (state->index == NULL) {
+            state->index = buildNextUse(state->offsetBits, trace);
+        }
+    }
+}
+
+// The line just accessed will next be accessed at nextUse of the current record
+static void optAccess(SimContext *ctx, CacheSet *set, int slot) {
+    OptState *state = ctx->cache->policyState;
+    const NextUseIndex *index = state->index;
+    size_t i = (size_t)setIndex(ctx->cache, set) * state->linesPerSet + slot;
+    state->slotNextUse[i] = index != NULL && ctx->record < index->records ? index->nextUse[ctx->record] : NO_NEXT_USE;
+}
+
+// Furthest next use times the bytes the line frees; lines that are never used again go
+// first, the largest of them before the others
+static int optVictim(SimContext *ctx, CacheSet *set, const CompressedCacheLine *line) {
+    const OptState *state = ctx->cache->policyState;
+    const uint32_t *slotNextUse = &(state->slotNextUse[(size_t)setIndex(ctx->cache, set) * state->linesPerSet]);
+    int victim = -1;
+    uint64_t best = 0;
+    for (uint64_t used = usedSlots(set); used != 0; used &= used - 1) {
+        int i = __builtin_ctzll(used);
+        uint64_t distance = slotNextUse[i] == NO_NEXT_USE ? NEVER_REUSED : slotNextUse[i] - ctx->record;
+        uint64_t score = distance * set->sizes[i];
+        if (victim == -1 || score > best) {
+            victim = i;
+            best = score;
+        }
+    }
+    return victim;
+}
+
+static void optReport(const Cache *cache) {
+    const NextUseIndex *index = ((const OptState *)cache->policyState)->index;
+    if (index != NULL) {
+        printf("Next-use index: %zu records, %zu distinct lines, shared by %u caches\n", index->records, index->lines, index->users);
+    }
+}
+
+const ReplacementPolicy optPolicy = {
+    .name = "opt", .victim = optVictim, .insert = optAccess, .hit = optAccess,
+    .createState = createOptState, .report = optReport, .prepare = optPrepare, .freeState = freeOptState
+};
@@ -0,0 +1,311 @@
+/*
+ * outputWriter.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include "compressedCache.h"
+
+static const char hexChars[] = "0123456789abcdef";
+
+typedef struct {
+    const char *name;
+    unsigned int width;            // Bytes per value
+} OutputColumn;
+
+// Same fields and order as the CSV header. Addresses are 32-bit in the simulator,
+// larger values (e.g. very old timestamps) saturate at the column maximum
+static const OutputColumn outputColumns[COLUMNAR_COLUMNS] = {
+    {"MemAddress", 4},
+    {"ifHit", 1},
+    {"ifEvict", 1},
+    {"roundedCompSize", 2},
+    {"timestamp", 4},
+    {"isZero", 1},
+    {"isSame", 1},
+    {"compSize", 2},
+    {"K", 1},
+    {"baseNum", 1},
+    {"compressor", 1}
+};
+
+static inline char *appendUnsigned(char *p, unsigned long value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+static inline char *appendSigned(char *p, long value) {
+    if (value < 0) {
+        *p++ = '-';
+        return appendUnsigned(p, -(unsigned long)value);
+    }
+    return appendUnsigned(p, value);
+}
+
+static inline char *appendHex(char *p, unsigned long value) {
+    char digits[16];
+    int n = 0;
+    do {
+        digits[n++] = hexChars[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    while (n > 0) {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+static void writeLittleEndian(unsigned char *bytes, unsigned long long value, unsigned int width) {
+    for (unsigned int i = 0; i < width; i++) {
+        bytes[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+static inline void storeColumn(OutputWriter *out, int column, unsigned long long value) {
+    unsigned int width = outputColumns[column].width;
+    unsigned long long maxValue = ~0ULL >> (64 - 8 * width);
+    if (value > maxValue) {
+        value = maxValue;
+    }
+    writeLittleEndian(out->columns[column] + (size_t)out->rows * width, value, width);
+}
+
+static void writeOrExit(const void *data, size_t size, FILE *file) {
+    if (size > 0 && fwrite(data, 1, size, file) != size) {
+        perror("Failed to write output file");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void flushOutputWriter(OutputWriter *out) {
+    if (out->format == OUTPUT_COLUMNAR) {
+        if (out->rows == 0) {
+            return;
+        }
+        unsigned char blockHeader[8];
+        writeLittleEndian(blockHeader, out->rows, 4);
+        writeLittleEndian(blockHeader + 4, 0, 4);
+        writeOrExit(blockHeader, sizeof(blockHeader), out->file);
+        for (int i = 0; i < COLUMNAR_COLUMNS; i++) {
+            writeOrExit(out->columns[i], (size_t)out->rows * outputColumns[i].width, out->file);
+        }
+        out->rows = 0;
+        return;
+    }
+    writeOrExit(out->buffer, out->used, out->file);
+    out->used = 0;
+}
+
+static int openColumnarWriter(OutputWriter *out, const char *policyName) {
+    for (int i = 0; i < COLUMNAR_COLUMNS; i++) {
+        out->columns[i] = malloc((size_t)COLUMNAR_BLOCK_ROWS * outputColumns[i].width);
+        if (out->columns[i] == NULL) {
+            return -1;
+        }
+    }
+
+    // The row count is patched in by closeOutputWriter
+    unsigned char header[44 + COLUMNAR_COLUMNS * 28];
+    memset(header, 0, sizeof(header));
+    memcpy(header, COLUMNAR_MAGIC, strlen(COLUMNAR_MAGIC));
+    writeLittleEndian(header + 8, COLUMNAR_VERSION, 4);
+    writeLittleEndian(header + 12, COLUMNAR_BLOCK_ROWS, 4);
+    writeLittleEndian(header + 16, COLUMNAR_COLUMNS, 4);
+    strncpy((char *)header + 20, policyName, 15);
+    for (int i = 0; i < COLUMNAR_COLUMNS; i++) {
+        unsigned char *column = header + 44 + i * 28;
+        strncpy((char *)column, outputColumns[i].name, 23);
+        writeLittleEndian(column + 24, outputColumns[i].width, 4);
+    }
+    return fwrite(header, 1, sizeof(header), out->file) == sizeof(header) ? 0 : -1;
+}
+
+/* =====================================================================================
+ * 
+ *                           Output file processing functions
+ *  
+ * =====================================================================================
+ */
+
+int openOutputWriter(OutputWriter *out, const char *filename, OutputFormat format, const char *policyName, SimSummary *summary) {
+    out->format = format;
+    out->summary = summary;
+    out->buffer = NULL;
+    out->used = 0;
+    out->rows = 0;
+    out->totalRows = 0;
+    for (int i = 0; i < COLUMNAR_COLUMNS; i++) {
+        out->columns[i] = NULL;
+    }
+
+    out->file = NULL;
+    if (format == OUTPUT_SUMMARY) {
+        return 0;  // Nothing is written per record
+    }
+
+    out->file = fopen(filename, format == OUTPUT_COLUMNAR ? "wb" : "w");
+    if (out->file == NULL) {
+        return -1;
+    }
+
+    if (format == OUTPUT_COLUMNAR) {
+        if (openColumnarWriter(out, policyName) != 0) {
+            closeOutputWriter(out);
+            return -1;
+        }
+        return 0;
+    }
+
+    out->buffer = malloc(OUTPUT_BUFFER_SIZE);
+    if (out->buffer == NULL) {
+        fclose(out->file);
+        out->file = NULL;
+        return -1;
+    }
+
+    const char *header = "MemAddress,ifHit,ifEvict,roundedCompSize,timestamp,isZero,isSame,compSize,K,baseNum,compressor\n";
+    size_t length = strlen(header);
+    memcpy(out->buffer, header, length);
+    out->used = length;
+    return 0;
+}
+
+void updateSimSummary(SimSummary *summary, const OutputInfo *info) {
+    if (info->ifEvict) {
+        unsigned long age = info->timestamp;
+        int ageBucket = age == 0 ? 0 : 64 - __builtin_clzl(age);
+        summary->evictions++;
+        summary->evictedSize[info->roundedCompSize / 4]++;
+        summary->victimAge[ageBucket < SUMMARY_AGE_BUCKETS ? ageBucket : SUMMARY_AGE_BUCKETS - 1]++;
+        summary->evictedBy[info->compResult.algorithm]++;
+        summary->storedEvictedBy[info->compResult.algorithm] += info->compResult.stored;
+        summary->pendingVictims++;
+    } else if (!info->ifHit) {
+        // Victims of a miss are written just before the miss record itself
+        summary->insertedSize[info->roundedCompSize / 4]++;
+        summary->insertedBy[info->compResult.algorithm]++;
+        summary->storedInsertedBy[info->compResult.algorithm] += info->compResult.stored;
+        summary->victimsPerMiss[summary->pendingVictims]++;
+        summary->pendingVictims = 0;
+    } else {
+        summary->hitsBy[info->compResult.algorithm]++;
+        summary->storedHitsBy[info->compResult.algorithm] += info->compResult.stored;
+    }
+}
+
+void mergeSimStats(SimStats *total, const SimStats *part) {
+    total->instructionCount += part->instructionCount;
+    total->loadCount += part->loadCount;
+    total->loadHitCount += part->loadHitCount;
+    total->storeCount += part->storeCount;
+    total->storeHitCount += part->storeHitCount;
+    total->summary.evictions += part->summary.evictions;
+    for (int i = 0; i < SUMMARY_SIZE_BUCKETS; i++) {
+        total->summary.insertedSize[i] += part->summary.insertedSize[i];
+        total->summary.evictedSize[i] += part->summary.evictedSize[i];
+    }
+    for (int i = 0; i < COMPRESSORS; i++) {
+        total->summary.insertedBy[i] += part->summary.insertedBy[i];
+        total->summary.evictedBy[i] += part->summary.evictedBy[i];
+        total->summary.hitsBy[i] += part->summary.hitsBy[i];
+        total->summary.storedInsertedBy[i] += part->summary.storedInsertedBy[i];
+        total->summary.storedEvictedBy[i] += part->summary.storedEvictedBy[i];
+        total->summary.storedHitsBy[i] += part->summary.storedHitsBy[i];
+    }
+    for (int i = 0; i < SUMMARY_VICTIM_BUCKETS; i++) {
+        total->summary.victimsPerMiss[i] += part->summary.victimsPerMiss[i];
+    }
+    for (int i = 0; i < SUMMARY_AGE_BUCKETS; i++) {
+        total->summary.victimAge[i] += part->summary.victimAge[i];
+    }
+}
+
+void writeOutputInfo(OutputWriter *out, const OutputInfo *info) {
+    updateSimSummary(out->summary, info);
+
+    if (out->format == OUTPUT_SUMMARY) {
+        return;
+    }
+    if (out->format == OUTPUT_COLUMNAR) {
+        storeColumn(out, 0, info->address);
+        storeColumn(out, 1, info->ifHit);
+        storeColumn(out, 2, info->ifEvict);
+        storeColumn(out, 3, info->roundedCompSize);
+        storeColumn(out, 4, info->timestamp);
+        storeColumn(out, 5, info->compResult.isZero);
+        storeColumn(out, 6, info->compResult.isSame);
+        storeColumn(out, 7, info->compResult.compSize);
+        storeColumn(out, 8, info->compResult.K);
+        storeColumn(out, 9, info->compResult.BaseNum);
+        storeColumn(out, 10, info->compResult.algorithm);
+        out->totalRows++;
+        if (++out->rows == COLUMNAR_BLOCK_ROWS) {
+            flushOutputWriter(out);
+        }
+        return;
+    }
+
+    if (out->used + OUTPUT_RECORD_MAX > OUTPUT_BUFFER_SIZE) {
+        flushOutputWriter(out);
+    }
+
+    // Same row layout as "%lx,%d,%d,%u,%lu,%u,%u,%u,%u,%u,%u\n" without going through printf
+    char *p = out->buffer + out->used;
+    p = appendHex(p, info->address);
+    *p++ = ',';
+    p = appendSigned(p, info->ifHit);
+    *p++ = ',';
+    p = appendSigned(p, info->ifEvict);
+    *p++ = ',';
+    p = appendUnsigned(p, info->roundedCompSize);
+    *p++ = ',';
+    p = appendUnsigned(p, info->timestamp);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.isZero);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.isSame);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.compSize);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.K);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.BaseNum);
+    *p++ = ',';
+    p = appendUnsigned(p, info->compResult.algorithm);
+    *p++ = '\n';
+    out->used = p - out->buffer;
+}
+
+void closeOutputWriter(OutputWriter *out) {
+    if (out->file != NULL) {
+        flushOutputWriter(out);
+        if (out->format == OUTPUT_COLUMNAR) {
+            unsigned char rowCount[8];
+            writeLittleEndian(rowCount, out->totalRows, 8);
+            if (fseek(out->file, 36, SEEK_SET) != 0) {
+                perror("Failed to write output file");
+            } else {
+                writeOrExit(rowCount, sizeof(rowCount), out->file);
+            }
+        }
+        if (fclose(out->file) != 0) {
+            perror("Failed to close output file");
+        }
+        out->file = NULL;
+    }
+    free(out->buffer);
+    out->buffer = NULL;
+    for (int i = 0; i < COLUMNAR_COLUMNS; i++) {
+        free(out->columns[i]);
+        out->columns[i] = NULL;
+    }
+}
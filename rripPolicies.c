@@ -0,0 +1,255 @@
+/*
+ * rripPolicies.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include "compressedCache.h"
+
+// Re-reference prediction values run from 0 (reused soon) to rrvp_max (distant)
+#define RRIP_LONG (rrvp_max - 1)
+#define BRRIP_LONG_ODDS 32          // Bimodal RRIP inserts 1 line in this many at RRIP_LONG
+#define PSEL_MAX 1023
+
+typedef struct {
+    unsigned int period;            // DUEL_PERIOD, or the set count for smaller caches
+    unsigned int psel;              // > PSEL_MAX / 2 while SRRIP leaders miss more
+} DrripState;
+
+typedef struct {
+    unsigned int period;
+    unsigned int classes;           // Size classes with a leader group
+    uint64_t prioritized;           // Bit c: lines of size class c are inserted near
+} SipState;
+
+typedef struct {
+    unsigned int threshold;         // Lines larger than this many bytes are inserted distant
+} EcmState;
+
+/* =====================================================================================
+ *
+ *                           RRIP helper functions
+ *
+ * =====================================================================================
+ */
+
+static inline unsigned int sizeClass(const CacheSet *set, int slot) {
+    return set->sizes[slot] / 4 - 1;
+}
+
+// Age every line until the most distant one reaches rrvp_max
+static void ageCacheSet(CacheSet *set, unsigned int highest) {
+    unsigned int age = rrvp_max - highest;
+    if (age == 0) {
+        return;
+    }
+    for (uint64_t used = usedSlots(set); used != 0; used &= used - 1) {
+        set->rrvp[__builtin_ctzll(used)] += age;
+    }
+}
+
+static unsigned int highestRrvp(const CacheSet *set) {
+    unsigned int highest = 0;
+    for (uint64_t used = usedSlots(set); used != 0; used &= used - 1) {
+        unsigned int rrvp = set->rrvp[__builtin_ctzll(used)];
+        if (rrvp > highest) {
+            highest = rrvp;
+        }
+    }
+    return highest;
+}
+
+// First line predicted to be re-referenced furthest in the future
+static int rripVictim(SimContext *ctx, CacheSet *set, const CompressedCacheLine *line) {
+    unsigned int highest = highestRrvp(set);
+    ageCacheSet(set, highest);
+    uint64_t used = usedSlots(set);
+    while (set->rrvp[__builtin_ctzll(used)] != rrvp_max) {
+        used &= used - 1;
+    }
+    return __builtin_ctzll(used);
+}
+
+static void rripHit(SimContext *ctx, CacheSet *set, int slot) {
+    set->rrvp[slot] = 0;
+}
+
+static void srripInsert(SimContext *ctx, CacheSet *set, int slot) {
+    set->rrvp[slot] = RRIP_LONG;
+}
+
+// Mostly distant, keyed by the set's own history so that shards draw the same values
+static unsigned int brripInsertion(const SimContext *ctx, const CacheSet *set, int slot) {
+    uint64_t key = ctx->seed ^ ((uint64_t)set->tags[slot] << 20) ^ set->clock;
+    return drawRandom(key, BRRIP_LONG_ODDS) == 0 ? RRIP_LONG : rrvp_max;
+}
+
+/* =====================================================================================
+ *
+ *                           DRRIP
+ *
+ * =====================================================================================
+ */
+
+static void *createDrripState(const CacheGeometry *geometry) {
+    DrripState *state = malloc(sizeof(DrripState));
+    if (state == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    state->period = duelPeriod(geometry);
+    state->psel = PSEL_MAX / 2;
+    return state;
+}
+
+// The first set of every period always inserts like SRRIP, the last like bimodal RRIP,
+// and their misses are counted in policyCounters[0] and [1]
+static void drripInsert(SimContext *ctx, CacheSet *set, int slot) {
+    const DrripState *state = ctx->cache->policyState;
+    unsigned int group = setIndex(ctx->cache, set) % state->period;
+    bool bimodal;
+    if (group == 0) {
+        ctx->policyCounters[0]++;
+        bimodal = false;
+    } else if (group == state->period - 1) {
+        ctx->policyCounters[1]++;
+        bimodal = true;
+    } else {
+        bimodal = state->psel > PSEL_MAX / 2;
+    }
+    set->rrvp[slot] = bimodal ? brripInsertion(ctx, set, slot) : RRIP_LONG;
+}
+
+static void drripTick(Cache *cache, const unsigned long *counters) {
+    DrripState *state = cache->policyState;
+    long psel = (long)state->psel + (long)counters[0] - (long)counters[1];
+    state->psel = psel < 0 ? 0 : (psel > PSEL_MAX ? PSEL_MAX : psel);
+}
+
+/* =====================================================================================
+ *
+ *                           SIP
+ *
+ * =====================================================================================
+ */
+
+static void *createSipState(const CacheGeometry *geometry) {
+    SipState *state = malloc(sizeof(SipState));
+    if (state == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    state->period = duelPeriod(geometry);
+    // Group 0 is the SRRIP baseline, group c + 1 prioritizes size class c
+    state->classes = geometry->lineSize / 4;
+    if (state->classes > state->period - 1) {
+        state->classes = state->period - 1;
+    }
+    state->prioritized = 0;
+    return state;
+}
+
+// Misses of leader group g are counted in policyCounters[g]
+static void sipInsert(SimContext *ctx, CacheSet *set, int slot) {
+    const SipState *state = ctx->cache->policyState;
+    unsigned int group = setIndex(ctx->cache, set) % state->period;
+    unsigned int size = sizeClass(set, slot);
+    bool near;
+    if (group <= state->classes) {
+        ctx->policyCounters[group]++;
+        near = group != 0 && size == group - 1;
+    } else {
+        near = (state->prioritized >> size) & 1;
+    }
+    set->rrvp[slot] = near ? 0 : RRIP_LONG;
+}
+
+// Prioritize the size classes whose leaders missed less than the baseline
+static void sipTick(Cache *cache, const unsigned long *counters) {
+    SipState *state = cache->policyState;
+    state->prioritized = 0;
+    for (unsigned int c = 0; c < state->classes; c++) {
+        if (counters[c + 1] < counters[0]) {
+            state->prioritized |= 1ULL << c;
+        }
+    }
+}
+
+/* =====================================================================================
+ *
+ *                           ECM
+ *
+ * =====================================================================================
+ */
+
+static void *createEcmState(const CacheGeometry *geometry) {
+    EcmState *state = malloc(sizeof(EcmState));
+    if (state == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+    state->threshold = geometry->lineSize / 2;
+    return state;
+}
+
+// Inserted lines are counted per size class in policyCounters
+static void ecmInsert(SimContext *ctx, CacheSet *set, int slot) {
+    const EcmState *state = ctx->cache->policyState;
+    ctx->policyCounters[sizeClass(set, slot)]++;
+    set->rrvp[slot] = set->sizes[slot] > state->threshold ? rrvp_max : RRIP_LONG;
+}
+
+// Largest of the lines predicted to be re-referenced furthest in the future
+static int ecmVictim(SimContext *ctx, CacheSet *set, const CompressedCacheLine *line) {
+    unsigned int highest = highestRrvp(set);
+    ageCacheSet(set, highest);
+    int victim = -1;
+    for (uint64_t used = usedSlots(set); used != 0; used &= used - 1) {
+        int i = __builtin_ctzll(used);
+        if (set->rrvp[i] == rrvp_max && (victim == -1 || set->sizes[i] > set->sizes[victim])) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+// The median size inserted last epoch splits big lines from small ones
+static void ecmTick(Cache *cache, const unsigned long *counters) {
+    EcmState *state = cache->policyState;
+    unsigned int classes = cache->geometry.lineSize / 4;
+    unsigned long total = 0;
+    for (unsigned int c = 0; c < classes; c++) {
+        total += counters[c];
+    }
+    if (total == 0) {
+        return;
+    }
+    unsigned long seen = 0;
+    for (unsigned int c = 0; c < classes; c++) {
+        seen += counters[c];
+        if (2 * seen >= total) {
+            state->threshold = (c + 1) * 4;
+            return;
+        }
+    }
+}
+
+const ReplacementPolicy srripPolicy = {
+    .name = "srrip", .victim = rripVictim, .insert = srripInsert, .hit = rripHit
+};
+
+const ReplacementPolicy drripPolicy = {
+    .name = "drrip", .victim = rripVictim, .insert = drripInsert, .hit = rripHit,
+    .createState = createDrripState, .tick = drripTick
+};
+
+const ReplacementPolicy sipPolicy = {
+    .name = "sip", .victim = rripVictim, .insert = sipInsert, .hit = rripHit,
+    .createState = createSipState, .tick = sipTick
+};
+
+const ReplacementPolicy ecmPolicy = {
+    .name = "ecm", .victim = ecmVictim, .insert = ecmInsert, .hit = rripHit,
+    .createState = createEcmState, .tick = ecmTick
+};
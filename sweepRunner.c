@@ -0,0 +1,156 @@
+/*
+ * sweepRunner.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdatomic.h>
+
+#include "compressedCache.h"
+
+typedef struct {
+    int trace;                     // Index into the sweep's traces
+    const ReplacementPolicy *policy;
+    CacheGeometry geometry;
+    unsigned int group;            // Jobs run together starting with this one, 0 if run by an earlier one
+    SimStats stats;                // Filled in once the job has run
+} SweepJob;
+
+typedef struct {
+    const TraceBuffer *traces;
+    unsigned long seed;
+    CompressionResult *compResult;
+    unsigned int compResultCount;
+    unsigned int epoch;
+    SweepJob *jobs;
+    size_t jobCount;
+    _Atomic size_t nextJob;        // Next job to hand to an idle thread
+} Sweep;
+
+/* =====================================================================================
+ *
+ *                           Sweep functions
+ *
+ * =====================================================================================
+ */
+
+// One pass over the job's trace for the job and the rest of its group
+static void runSweepJob(const Sweep *sweep, SweepJob *job) {
+    Cache caches[MAX_CACHE_CONFIGS];
+    SimContext contexts[MAX_CACHE_CONFIGS];
+    for (unsigned int i = 0; i < job->group; i++) {
+        initializeCache(&caches[i], &(job[i].geometry), job[i].policy);
+        initializeSimContext(&contexts[i], &caches[i], sweep->seed, sweep->compResult, sweep->compResultCount);
+        contexts[i].epoch = sweep->epoch;
+    }
+    simulateTraceBuffer(contexts, job->group, &(sweep->traces[job->trace]), 1);
+    for (unsigned int i = 0; i < job->group; i++) {
+        job[i].stats = contexts[i].stats;
+        freeCache(&caches[i]);
+    }
+}
+
+static void *sweepThread(void *arg) {
+    Sweep *sweep = arg;
+    size_t next;
+    while ((next = atomic_fetch_add(&sweep->nextJob, 1)) < sweep->jobCount) {
+        if (sweep->jobs[next].group != 0) {
+            runSweepJob(sweep, &(sweep->jobs[next]));
+        }
+    }
+    return NULL;
+}
+
+static double hitRate(long hits, long accesses) {
+    return accesses == 0 ? 0 : (double)hits / (double)accesses;
+}
+
+static void printSweepTable(FILE *file, bool csv, char *const *traceNames, const SweepJob *jobs, size_t jobCount) {
+    const char *header = csv ? "trace,policy,sizeKB,lineSize,ways,accesses,hitRate,loadHitRate,storeHitRate,evictions\n"
+                             : "%-24s %-8s %6s %5s %4s %10s %8s %8s %8s %10s\n";
+    if (csv) {
+        fputs(header, file);
+    } else {
+        fprintf(file, header, "Trace", "Policy", "SizeKB", "Line", "Ways", "Accesses", "HitRate", "LoadHit", "StoreHit", "Evictions");
+    }
+    for (size_t i = 0; i < jobCount; i++) {
+        const SweepJob *job = &jobs[i];
+        const SimStats *stats = &(job->stats);
+        fprintf(file, csv ? "%s,%s,%u,%u,%u,%ld,%f,%f,%f,%lu\n" : "%-24s %-8s %6u %5u %4u %10ld %8.6f %8.6f %8.6f %10lu\n",
+                traceNames[job->trace], job->policy->name,
+                job->geometry.cacheSizeKB, job->geometry.lineSize, job->geometry.associativity,
+                stats->instructionCount,
+                hitRate(stats->loadHitCount + stats->storeHitCount, stats->instructionCount),
+                hitRate(stats->loadHitCount, stats->loadCount),
+                hitRate(stats->storeHitCount, stats->storeCount),
+                stats->summary.evictions);
+    }
+}
+
+void runSweep(char *const *traceNames, int traceCount, const ReplacementPolicy *const *policies, int policyCount,
+              const CacheGeometry *geometries, int geometryCount, unsigned long seed,
+              CompressionResult *compResult, unsigned int compResultCount, unsigned int epoch, unsigned int threads) {
+    TraceBuffer *traces = malloc(traceCount * sizeof(TraceBuffer));
+    Sweep sweep = {traces, seed, compResult, compResultCount, epoch, NULL, (size_t)traceCount * policyCount * geometryCount, 0};
+    sweep.jobs = malloc(sweep.jobCount * sizeof(SweepJob));
+    pthread_t *pool = malloc(threads * sizeof(pthread_t));
+    if (traces == NULL || sweep.jobs == NULL || pool == NULL) {
+        perror("Memory allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // Each trace is decoded once and shared read-only by all of its jobs
+    for (int t = 0; t < traceCount; t++) {
+        if (loadTraceBuffer(&traces[t], traceNames[t]) != 0) {
+            perror(traceNames[t]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    size_t n = 0;
+    for (int t = 0; t < traceCount; t++) {
+        for (int p = 0; p < policyCount; p++) {
+            for (int g = 0; g < geometryCount; g++) {
+                sweep.jobs[n].trace = t;
+                sweep.jobs[n].policy = policies[p];
+                sweep.jobs[n].geometry = geometries[g];
+                // Offline policies prepare every geometry of a trace in one group, so what
+                // they build from the trace is shared instead of rebuilt per geometry
+                sweep.jobs[n].group = policies[p]->prepare == NULL ? 1 : (g == 0 ? geometryCount : 0);
+                n++;
+            }
+        }
+    }
+
+    if (threads > sweep.jobCount) {
+        threads = sweep.jobCount;
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        if (pthread_create(&pool[i], NULL, sweepThread, &sweep) != 0) {
+            perror("Failed to start worker threads");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (unsigned int i = 0; i < threads; i++) {
+        pthread_join(pool[i], NULL);
+    }
+
+    printf("\nSeed: %lu\n", seed);
+    printSweepTable(stdout, false, traceNames, sweep.jobs, sweep.jobCount);
+
+    FILE *file = fopen("testOutput/sweep.csv", "w");
+    if (file == NULL) {
+        perror("Unable to open file");
+    } else {
+        printSweepTable(file, true, traceNames, sweep.jobs, sweep.jobCount);
+        fclose(file);
+    }
+
+    for (int t = 0; t < traceCount; t++) {
+        freeTraceBuffer(&traces[t]);
+    }
+    free(traces);
+    free(sweep.jobs);
+    free(pool);
+}
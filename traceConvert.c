@@ -0,0 +1,85 @@
+/*
+ * traceConvert.c
+ * 
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "traceReader.h"
+
+///
+/// Text traces are converted to the binary format and binary traces back to text
+///
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input trace> <output trace>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    TraceReader reader;
+    if (openTraceReader(&reader, argv[1]) != 0) {
+        perror("Error opening input file");
+        return EXIT_FAILURE;
+    }
+
+    TraceRecord record;
+    TraceStatus status;
+    unsigned long long records = 0;
+    unsigned long long malformed = 0;
+    int failed = 0;
+
+    if (reader.format == TRACE_TEXT) {
+        TraceWriter writer;
+        if (openTraceWriter(&writer, argv[2]) != 0) {
+            perror("Error opening output file");
+            closeTraceReader(&reader);
+            return EXIT_FAILURE;
+        }
+        while ((status = nextTraceRecord(&reader, &record)) != TRACE_END) {
+            if (status == TRACE_MALFORMED) {
+                malformed++;
+                continue;
+            }
+            if (writeTraceRecord(&writer, &record) != 0) {
+                failed = 1;
+                break;
+            }
+            records++;
+        }
+        if (closeTraceWriter(&writer) != 0) {
+            failed = 1;
+        }
+    } else {
+        FILE *output = fopen(argv[2], "w");
+        if (output == NULL) {
+            perror("Error opening output file");
+            closeTraceReader(&reader);
+            return EXIT_FAILURE;
+        }
+        while ((status = nextTraceRecord(&reader, &record)) != TRACE_END) {
+            if (status == TRACE_MALFORMED) {
+                malformed++;
+                continue;
+            }
+            fprintf(output, "%c 0x%08lx\n", record.operation, record.address);
+            records++;
+        }
+        if (fclose(output) != 0) {
+            failed = 1;
+        }
+    }
+
+    size_t inputSize = reader.size;
+    closeTraceReader(&reader);
+
+    if (failed) {
+        perror("Error writing output file");
+        return EXIT_FAILURE;
+    }
+
+    printf("Converted %llu records (%llu malformed skipped), %zu bytes in\n", records, malformed, inputSize);
+    return EXIT_SUCCESS;
+}
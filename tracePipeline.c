@@ -0,0 +1,115 @@
+/*
+ * tracePipeline.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <sched.h>
+
+#include "tracePipeline.h"
+
+// Spin briefly before giving the core away, batches are large so waits are rare
+static void waitForRing(unsigned int *spins) {
+    if (++(*spins) > 64) {
+        sched_yield();
+    }
+}
+
+static void *traceReaderThread(void *arg) {
+    TracePipeline *pipeline = arg;
+    size_t head = atomic_load_explicit(&pipeline->head, memory_order_relaxed);
+    TraceStatus status = TRACE_RECORD;
+
+    while (status != TRACE_END) {
+        unsigned int spins = 0;
+        while (head - atomic_load_explicit(&pipeline->tail, memory_order_acquire) == TRACE_RING_SLOTS) {
+            waitForRing(&spins);
+        }
+
+        TraceBatch *batch = &pipeline->batches[head % TRACE_RING_SLOTS];
+        batch->count = 0;
+        batch->malformed = 0;
+        while (batch->count < TRACE_BATCH_SIZE &&
+               (status = nextTraceRecord(&pipeline->reader, &batch->records[batch->count])) != TRACE_END) {
+            if (status == TRACE_RECORD) {
+                batch->count++;
+            } else {
+                batch->malformed++;
+            }
+        }
+
+        head++;
+        atomic_store_explicit(&pipeline->head, head, memory_order_release);
+    }
+
+    atomic_store_explicit(&pipeline->done, 1, memory_order_release);
+    return NULL;
+}
+
+/* =====================================================================================
+ *
+ *                           Pipeline functions
+ *
+ * =====================================================================================
+ */
+
+int startTracePipeline(TracePipeline *pipeline, const char *filename) {
+    if (openTraceReader(&pipeline->reader, filename) != 0) {
+        return -1;
+    }
+
+    pipeline->batches = malloc(TRACE_RING_SLOTS * sizeof(TraceBatch));
+    if (pipeline->batches == NULL) {
+        closeTraceReader(&pipeline->reader);
+        return -1;
+    }
+    atomic_init(&pipeline->head, 0);
+    atomic_init(&pipeline->tail, 0);
+    atomic_init(&pipeline->done, 0);
+
+    int err = pthread_create(&pipeline->thread, NULL, traceReaderThread, pipeline);
+    if (err != 0) {
+        free(pipeline->batches);
+        closeTraceReader(&pipeline->reader);
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+TraceBatch *acquireTraceBatch(TracePipeline *pipeline) {
+    size_t tail = atomic_load_explicit(&pipeline->tail, memory_order_relaxed);
+    unsigned int spins = 0;
+
+    while (atomic_load_explicit(&pipeline->head, memory_order_acquire) == tail) {
+        if (atomic_load_explicit(&pipeline->done, memory_order_acquire)) {
+            // done is published after the final head, so one more look is enough
+            if (atomic_load_explicit(&pipeline->head, memory_order_acquire) == tail) {
+                return NULL;
+            }
+            break;
+        }
+        waitForRing(&spins);
+    }
+    return &pipeline->batches[tail % TRACE_RING_SLOTS];
+}
+
+void releaseTraceBatch(TracePipeline *pipeline) {
+    size_t tail = atomic_load_explicit(&pipeline->tail, memory_order_relaxed);
+    atomic_store_explicit(&pipeline->tail, tail + 1, memory_order_release);
+}
+
+void stopTracePipeline(TracePipeline *pipeline) {
+    // Drain whatever the reader still publishes so it can run to completion
+    while (acquireTraceBatch(pipeline) != NULL) {
+        releaseTraceBatch(pipeline);
+    }
+    pthread_join(pipeline->thread, NULL);
+    free(pipeline->batches);
+    pipeline->batches = NULL;
+    closeTraceReader(&pipeline->reader);
+}
@@ -0,0 +1,79 @@
+/*
+ * tracePipeline.h
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#ifndef _TRACE_PIPELINE_H_
+#define _TRACE_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "traceReader.h"
+
+/* =====================================================================================
+ *
+ *                               Macros values
+ *
+ * =====================================================================================
+ */
+
+#define TRACE_BATCH_SIZE 4096      // Records decoded per batch
+#define TRACE_RING_SLOTS 8         // Batches in flight between reader and simulator
+
+
+/* =====================================================================================
+ *
+ *                              Pipeline Structures
+ *
+ * =====================================================================================
+ */
+
+typedef struct {
+    unsigned int count;            // Decoded records in this batch
+    unsigned int malformed;        // Lines skipped while filling this batch
+    TraceRecord records[TRACE_BATCH_SIZE];
+} TraceBatch;
+
+///
+/// Single-producer/single-consumer ring: the reader thread only advances head,
+/// the simulation thread only advances tail
+///
+typedef struct {
+    TraceReader reader;
+    TraceBatch *batches;
+    _Atomic size_t head;           // Batches published by the reader thread
+    _Atomic size_t tail;           // Batches released by the simulation thread
+    _Atomic int done;              // Set once the last batch has been published
+    pthread_t thread;
+} TracePipeline;
+
+
+/* =====================================================================================
+ *
+ *                           Pipeline functions
+ *
+ * =====================================================================================
+ */
+
+///
+/// Open the trace and start the reader thread. Returns 0 on success, -1 on failure
+///
+int startTracePipeline(TracePipeline *pipeline, const char *filename);
+
+///
+/// Wait for the next decoded batch. Returns NULL once the trace is exhausted
+///
+TraceBatch *acquireTraceBatch(TracePipeline *pipeline);
+
+///
+/// Hand the batch returned by acquireTraceBatch back to the reader thread
+///
+void releaseTraceBatch(TracePipeline *pipeline);
+
+void stopTracePipeline(TracePipeline *pipeline);
+
+#endif
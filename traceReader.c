@@ -0,0 +1,340 @@
+/*
+ * traceReader.c
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "traceReader.h"
+
+// Bit 4 marks a valid hex digit, the low nibble holds its value
+static const unsigned char hexDigit[256] = {
+    ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+    ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+    ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+    ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+};
+
+/* =====================================================================================
+ *
+ *                           Trace reading functions
+ *
+ * =====================================================================================
+ */
+
+static unsigned long long readLittleEndian(const unsigned char *bytes, unsigned size) {
+    unsigned long long value = 0;
+    for (unsigned i = 0; i < size; i++) {
+        value |= (unsigned long long)bytes[i] << (8 * i);
+    }
+    return value;
+}
+
+static void writeLittleEndian(unsigned char *bytes, unsigned long long value, unsigned size) {
+    for (unsigned i = 0; i < size; i++) {
+        bytes[i] = (value >> (8 * i)) & 0xFF;
+    }
+}
+
+int openTraceReader(TraceReader *reader, const char *filename) {
+    reader->filename = filename;
+    reader->data = NULL;
+    reader->size = 0;
+    reader->pos = 0;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    if (st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return -1;
+        }
+        madvise(data, st.st_size, MADV_SEQUENTIAL);
+        reader->data = data;
+        reader->size = st.st_size;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+
+    reader->format = TRACE_TEXT;
+    if (reader->size >= BINARY_TRACE_HEADER_SIZE &&
+        memcmp(reader->data, BINARY_TRACE_MAGIC, 8) == 0) {
+        if (readLittleEndian(reader->data + 8, 4) != BINARY_TRACE_VERSION ||
+            readLittleEndian(reader->data + 12, 4) != BINARY_TRACE_BLOCK) {
+            closeTraceReader(reader);
+            errno = EINVAL;
+            return -1;
+        }
+        reader->format = TRACE_BINARY;
+        reader->recordsLeft = readLittleEndian(reader->data + 16, 8);
+        reader->blockLeft = 0;
+        reader->opBits = 0;
+        reader->prevAddress = 0;
+        reader->pos = BINARY_TRACE_HEADER_SIZE;
+    }
+    return 0;
+}
+
+void closeTraceReader(TraceReader *reader) {
+    if (reader->data != NULL) {
+        munmap((void *)reader->data, reader->size);
+        reader->data = NULL;
+    }
+    reader->size = 0;
+    reader->pos = 0;
+}
+
+// Parse "<op> 0x<hex>" between p and end, anything after the address is ignored
+static inline int parseTraceLine(const unsigned char *p, const unsigned char *end, TraceRecord *record) {
+    if (p >= end || (*p != 'l' && *p != 's')) {
+        return 0;
+    }
+    record->operation = *p++;
+
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    if (end - p < 3 || p[0] != '0' || (p[1] | 0x20) != 'x') {
+        return 0;
+    }
+    p += 2;
+
+    unsigned long address = 0;
+    const unsigned char *digits = p;
+    unsigned char d;
+    while (p < end && ((d = hexDigit[*p]) & 0x10)) {
+        address = (address << 4) | (d & 0x0F);
+        p++;
+    }
+    if (p == digits || p - digits > 2 * (long)sizeof(unsigned long)) {
+        return 0;
+    }
+    record->address = address;
+    return 1;
+}
+
+static TraceStatus nextBinaryRecord(TraceReader *reader, TraceRecord *record) {
+    if (reader->recordsLeft == 0) {
+        return TRACE_END;
+    }
+
+    const unsigned char *p = reader->data + reader->pos;
+    const unsigned char *end = reader->data + reader->size;
+
+    if (reader->blockLeft == 0) {
+        unsigned int count = reader->recordsLeft < BINARY_TRACE_BLOCK ? reader->recordsLeft : BINARY_TRACE_BLOCK;
+        unsigned int bitmapSize = (count + 7) / 8;
+        if ((size_t)(end - p) < bitmapSize) {
+            goto truncated;
+        }
+        reader->opBits = readLittleEndian(p, bitmapSize);
+        reader->blockLeft = count;
+        p += bitmapSize;
+    }
+
+    unsigned long long zigzag = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do {
+        if (p == end || shift > 63) {
+            goto truncated;
+        }
+        byte = *p++;
+        zigzag |= (unsigned long long)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    reader->prevAddress += (unsigned long)((zigzag >> 1) ^ -(zigzag & 1));
+    record->address = reader->prevAddress;
+    record->operation = (reader->opBits & 1) ? 's' : 'l';
+
+    reader->opBits >>= 1;
+    reader->blockLeft--;
+    reader->recordsLeft--;
+    reader->pos = p - reader->data;
+    return TRACE_RECORD;
+
+truncated:
+    fprintf(stderr, "Error parsing %s at byte offset %zu: truncated binary record\n", reader->filename, reader->pos);
+    reader->recordsLeft = 0;
+    reader->pos = reader->size;
+    return TRACE_MALFORMED;
+}
+
+TraceStatus nextTraceRecord(TraceReader *reader, TraceRecord *record) {
+    if (reader->format == TRACE_BINARY) {
+        return nextBinaryRecord(reader, record);
+    }
+    if (reader->pos >= reader->size) {
+        return TRACE_END;
+    }
+
+    size_t offset = reader->pos;
+    const unsigned char *line = reader->data + offset;
+    const unsigned char *newline = memchr(line, '\n', reader->size - offset);
+    const unsigned char *end = newline != NULL ? newline : reader->data + reader->size;
+
+    reader->pos = (end - reader->data) + (newline != NULL);
+
+    if (parseTraceLine(line, end, record)) {
+        return TRACE_RECORD;
+    }
+
+    int length = end - line;
+    if (length > 0 && line[length - 1] == '\r') {
+        length--;
+    }
+    fprintf(stderr, "Error parsing %s at byte offset %zu: %.*s\n", reader->filename, offset, length, line);
+    return TRACE_MALFORMED;
+}
+
+int loadTraceBuffer(TraceBuffer *buffer, const char *filename) {
+    buffer->records = NULL;
+    buffer->count = 0;
+    buffer->malformed = 0;
+
+    TraceReader reader;
+    if (openTraceReader(&reader, filename) != 0) {
+        return -1;
+    }
+
+    // Exact for binary traces, text lines take at least "l 0x0\n"
+    size_t capacity = reader.format == TRACE_BINARY ? reader.recordsLeft : reader.size / 6;
+    if (capacity == 0) {
+        capacity = 1;
+    }
+    buffer->records = malloc(capacity * sizeof(TraceRecord));
+    if (buffer->records == NULL) {
+        closeTraceReader(&reader);
+        return -1;
+    }
+
+    TraceStatus status;
+    while ((status = nextTraceRecord(&reader, &buffer->records[buffer->count])) != TRACE_END) {
+        if (status == TRACE_MALFORMED) {
+            buffer->malformed++;
+        } else if (++buffer->count == capacity) {
+            capacity *= 2;
+            TraceRecord *records = realloc(buffer->records, capacity * sizeof(TraceRecord));
+            if (records == NULL) {
+                freeTraceBuffer(buffer);
+                closeTraceReader(&reader);
+                return -1;
+            }
+            buffer->records = records;
+        }
+    }
+    closeTraceReader(&reader);
+    return 0;
+}
+
+void freeTraceBuffer(TraceBuffer *buffer) {
+    free(buffer->records);
+    buffer->records = NULL;
+    buffer->count = 0;
+}
+
+/* =====================================================================================
+ *
+ *                           Trace writing functions
+ *
+ * =====================================================================================
+ */
+
+int openTraceWriter(TraceWriter *writer, const char *filename) {
+    writer->file = fopen(filename, "wb");
+    if (writer->file == NULL) {
+        return -1;
+    }
+    writer->recordCount = 0;
+    writer->blockCount = 0;
+    writer->opBits = 0;
+    writer->deltaSize = 0;
+    writer->prevAddress = 0;
+
+    // The record count is patched in by closeTraceWriter
+    unsigned char header[BINARY_TRACE_HEADER_SIZE];
+    memcpy(header, BINARY_TRACE_MAGIC, 8);
+    writeLittleEndian(header + 8, BINARY_TRACE_VERSION, 4);
+    writeLittleEndian(header + 12, BINARY_TRACE_BLOCK, 4);
+    writeLittleEndian(header + 16, 0, 8);
+    if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header)) {
+        fclose(writer->file);
+        writer->file = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static int flushTraceBlock(TraceWriter *writer) {
+    if (writer->blockCount == 0) {
+        return 0;
+    }
+    unsigned char bitmap[BINARY_TRACE_BLOCK / 8];
+    unsigned int bitmapSize = (writer->blockCount + 7) / 8;
+    writeLittleEndian(bitmap, writer->opBits, bitmapSize);
+    if (fwrite(bitmap, 1, bitmapSize, writer->file) != bitmapSize ||
+        fwrite(writer->deltas, 1, writer->deltaSize, writer->file) != writer->deltaSize) {
+        return -1;
+    }
+    writer->blockCount = 0;
+    writer->opBits = 0;
+    writer->deltaSize = 0;
+    return 0;
+}
+
+int writeTraceRecord(TraceWriter *writer, const TraceRecord *record) {
+    long delta = (long)(record->address - writer->prevAddress);
+    unsigned long long zigzag = ((unsigned long long)delta << 1) ^ (unsigned long long)(delta >> 63);
+    writer->prevAddress = record->address;
+
+    if (record->operation == 's') {
+        writer->opBits |= 1ULL << writer->blockCount;
+    }
+    while (zigzag >= 0x80) {
+        writer->deltas[writer->deltaSize++] = (zigzag & 0x7F) | 0x80;
+        zigzag >>= 7;
+    }
+    writer->deltas[writer->deltaSize++] = zigzag;
+
+    writer->recordCount++;
+    if (++writer->blockCount == BINARY_TRACE_BLOCK) {
+        return flushTraceBlock(writer);
+    }
+    return 0;
+}
+
+int closeTraceWriter(TraceWriter *writer) {
+    int status = flushTraceBlock(writer);
+
+    unsigned char count[8];
+    writeLittleEndian(count, writer->recordCount, 8);
+    if (fseek(writer->file, 16, SEEK_SET) != 0 || fwrite(count, 1, sizeof(count), writer->file) != sizeof(count)) {
+        status = -1;
+    }
+    if (fclose(writer->file) != 0) {
+        status = -1;
+    }
+    writer->file = NULL;
+    return status;
+}
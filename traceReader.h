@@ -0,0 +1,125 @@
+/*
+ * traceReader.h
+ *
+ * Created by Penggao Li
+ * Last modified: 10/17/2026
+ */
+
+#ifndef _TRACE_READER_H_
+#define _TRACE_READER_H_
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* =====================================================================================
+ *
+ *                               Macros values
+ *
+ * =====================================================================================
+ */
+
+// Binary trace layout (all integers little-endian):
+//   header: "BDITRACE" | u32 version | u32 records per block | u64 record count
+//   block:  op bitmap, one bit per record (1 = store), rounded up to whole bytes
+//           followed by one zig-zag varint address delta per record
+#define BINARY_TRACE_MAGIC "BDITRACE"
+#define BINARY_TRACE_VERSION 1
+#define BINARY_TRACE_BLOCK 64
+#define BINARY_TRACE_HEADER_SIZE 24
+#define BINARY_TRACE_SUFFIX ".btrace"
+
+/* =====================================================================================
+ *
+ *                              Trace Structures
+ *
+ * =====================================================================================
+ */
+
+typedef struct {
+    char operation;            // 'l' for load, 's' for store
+    unsigned long address;
+} TraceRecord;
+
+typedef enum {
+    TRACE_RECORD,              // A record was decoded
+    TRACE_MALFORMED,           // The line could not be parsed and was skipped
+    TRACE_END                  // No more lines in the trace
+} TraceStatus;
+
+typedef enum {
+    TRACE_TEXT,
+    TRACE_BINARY
+} TraceFormat;
+
+typedef struct {
+    const char *filename;
+    const unsigned char *data; // Memory-mapped trace file
+    size_t size;               // Size of the mapping in bytes
+    size_t pos;                // Byte offset of the next unread line / record
+    TraceFormat format;        // Detected from the file header
+    unsigned long long recordsLeft; // Binary only: records not decoded yet
+    unsigned int blockLeft;    // Binary only: records left in the current block
+    unsigned long long opBits; // Binary only: op bits of the current block, LSB first
+    unsigned long prevAddress; // Binary only: base for the next address delta
+} TraceReader;
+
+///
+/// A whole decoded trace, shared read-only by every simulation that runs over it
+///
+typedef struct {
+    TraceRecord *records;
+    size_t count;
+    size_t malformed;          // Lines skipped while decoding
+} TraceBuffer;
+
+typedef struct {
+    FILE *file;
+    unsigned long long recordCount;
+    unsigned int blockCount;   // Records buffered in the current block
+    unsigned long long opBits;
+    unsigned char deltas[BINARY_TRACE_BLOCK * 10]; // Varints of the current block
+    size_t deltaSize;
+    unsigned long prevAddress;
+} TraceWriter;
+
+
+/* =====================================================================================
+ *
+ *                           Trace reading functions
+ *
+ * =====================================================================================
+ */
+
+///
+/// Map a trace file into memory and detect whether it is a text or binary trace.
+/// Returns 0 on success, -1 on failure (errno is set)
+///
+int openTraceReader(TraceReader *reader, const char *filename);
+
+void closeTraceReader(TraceReader *reader);
+
+///
+/// Decode the next "l 0x..." / "s 0x..." line or binary record. Malformed input is
+/// reported on stderr together with its byte offset and TRACE_MALFORMED is returned
+///
+TraceStatus nextTraceRecord(TraceReader *reader, TraceRecord *record);
+
+///
+/// Decode every record of a trace into buffer. Malformed lines are reported as by
+/// nextTraceRecord and counted. Returns 0 on success, -1 on failure (errno is set)
+///
+int loadTraceBuffer(TraceBuffer *buffer, const char *filename);
+
+void freeTraceBuffer(TraceBuffer *buffer);
+
+///
+/// Write a binary trace. closeTraceWriter flushes the last block and patches the
+/// record count in the header. Both return 0 on success, -1 on failure
+///
+int openTraceWriter(TraceWriter *writer, const char *filename);
+
+int writeTraceRecord(TraceWriter *writer, const TraceRecord *record);
+
+int closeTraceWriter(TraceWriter *writer);
+
+#endif